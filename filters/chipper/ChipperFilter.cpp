@@ -98,10 +98,19 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
     if (view->size() == 0)
         return m_outViews;
 
+    // The three reference lists, plus the buffer used to sort them, are
+    // charged before they're allocated so that a memory budget fails here.
+    MemoryCharge charge(view->memory(), MemoryTracker::StageData);
+    charge.set(4 * view->size() * sizeof(ChipPtRef));
+
     m_inView = view;
     load(*view.get(), m_xvec, m_yvec, m_spare);
     partition(m_xvec.size());
     decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
+
+    m_xvec.clear();
+    m_yvec.clear();
+    m_spare.clear();
     return m_outViews;
 }
 
@@ -105,6 +105,11 @@ private:
     {
         m_vec.resize(n);
     }
+    // Free the storage, not just the elements.
+    void clear()
+    {
+        std::vector<ChipPtRef>().swap(m_vec);
+    }
     void push_back(const ChipPtRef& ref)
     {
         m_vec.push_back(ref);
@@ -143,6 +148,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y" };
+        return true;
+    }
 
     Options getDefaultOptions();
 
@@ -80,6 +80,8 @@ public:
     std::string getName() const;
 
     Options getDefaultOptions();
+    virtual bool streamable() const
+        { return true; }
 
 private:
     virtual void initialize();
@@ -135,8 +135,42 @@ void CropFilter::processOptions(const Options& options)
 }
 
 
-void CropFilter::ready(PointTableRef /*table*/)
+// Cropping to a single box can be done by a reader.
+bool CropFilter::predicates(DimPredicateList& preds) const
 {
+    const Options& ops = getOptions();
+    if (ops.getValueOrDefault<bool>("outside", false))
+        return false;
+    for (const std::string& poly : ops.getValues<std::string>("polygon"))
+        if (poly.size())
+            return false;
+
+    std::vector<BOX2D> bounds;
+    try
+    {
+        bounds = ops.getValues<BOX2D>("bounds");
+    }
+    catch (boost::bad_lexical_cast)
+    {
+        return false;
+    }
+    if (bounds.size() != 1)
+        return false;
+
+    const BOX2D& box = bounds.front();
+    preds.push_back(DimPredicate("X", box.minx, box.maxx));
+    preds.push_back(DimPredicate("Y", box.miny, box.maxy));
+    return true;
+}
+
+
+void CropFilter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+    m_x.init(layout, Dimension::Id::X);
+    m_y.init(layout, Dimension::Id::Y);
+    m_z.init(layout, Dimension::Id::Z);
+
 #ifdef PDAL_HAVE_GEOS
     for (auto& g : m_geoms)
         preparePolygon(g);
@@ -211,33 +245,52 @@ Options CropFilter::getDefaultOptions()
 PointViewSet CropFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
+    if (predicatesPushed())
+    {
+        viewSet.insert(view);
+        return viewSet;
+    }
 #ifdef PDAL_HAVE_GEOS
     for (const auto& geom : m_geoms)
     {
-        PointViewPtr outView = view->makeNew();
-        crop(geom, *view, *outView);
-        viewSet.insert(outView);
+        PointSelection sel(view->size());
+        crop(geom, *view, sel);
+        viewSet.insert(view->makeSubset(sel));
     }
 #endif
     for (auto& box : m_bounds)
     {
-        PointViewPtr outView = view->makeNew();
-        crop(box, *view, *outView);
-        viewSet.insert(outView);
+        PointSelection sel(view->size());
+        crop(box, *view, sel);
+        viewSet.insert(view->makeSubset(sel));
     }
     return viewSet;
 }
 
-void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
+
+// Only used when there's a single box or polygon (see selects()).
+void CropFilter::select(PointView& view, PointSelection& sel)
+{
+    if (predicatesPushed())
+        return;
+#ifdef PDAL_HAVE_GEOS
+    for (const auto& geom : m_geoms)
+        crop(geom, view, sel);
+#endif
+    for (auto& box : m_bounds)
+        crop(box, view, sel);
+}
+
+
+void CropFilter::crop(const BOX2D& box, PointView& input, PointSelection& sel)
 {
-    for (PointId idx = 0; idx < input.size(); ++idx)
+    for (PointId idx = sel.first(); idx < sel.size(); idx = sel.next(idx))
     {
-        double x = input.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = input.getFieldAs<double>(Dimension::Id::Y, idx);
+        double x = m_x.get(input, idx);
+        double y = m_y.get(input, idx);
 
-        bool contained = box.contains(x, y);
-        if (m_cropOutside != box.contains(x, y))
-            output.appendPoint(input, idx);
+        if (m_cropOutside == box.contains(x, y))
+            sel.clear(idx);
     }
 }
 
@@ -263,17 +316,17 @@ GEOSGeometry *CropFilter::createPoint(double x, double y, double z)
 
 
 
-void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
+void CropFilter::crop(const GeomPkg& g, PointView& input, PointSelection& sel)
 {
     bool logOutput = (log()->getLevel() > LogLevel::Debug4);
     if (logOutput)
         log()->floatPrecision(8);
 
-    for (PointId idx = 0; idx < input.size(); ++idx)
+    for (PointId idx = sel.first(); idx < sel.size(); idx = sel.next(idx))
     {
-        double x = input.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = input.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = input.getFieldAs<double>(Dimension::Id::Z, idx);
+        double x = m_x.get(input, idx);
+        double y = m_y.get(input, idx);
+        double z = m_z.get(input, idx);
 
         if (logOutput)
         {
@@ -285,8 +338,8 @@ void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
         GEOSGeometry *p = createPoint(x, y, z);
         bool contained = (bool)(GEOSPreparedContains_r(m_geosEnvironment,
             g.m_prepGeom, p));
-        if (m_cropOutside != contained)
-            output.appendPoint(input, idx);
+        if (m_cropOutside == contained)
+            sel.clear(idx);
         GEOSGeom_destroy_r(m_geosEnvironment, p);
     }
 }
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 
 #ifdef PDAL_HAVE_GEOS
@@ -56,6 +57,20 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y", "Z" };
+        return true;
+    }
+    virtual bool predicates(DimPredicateList& preds) const;
+    virtual bool streamable() const
+        { return true; }
+    // The GEOS context is shared, so only cropping to boxes is thread-safe.
+    virtual bool threadSafe() const
+        { return m_geoms.empty(); }
+    // Cropping to more than one area makes a view for each.
+    virtual bool selects() const
+        { return m_bounds.size() + m_geoms.size() == 1; }
 
     Options getDefaultOptions();
 
@@ -78,13 +93,17 @@ private:
     };
 
     std::vector<GeomPkg> m_geoms;
+    DimAccessor<double> m_x;
+    DimAccessor<double> m_y;
+    DimAccessor<double> m_z;
 
     virtual void processOptions(const Options& options);
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual void select(PointView& view, PointSelection& sel);
     virtual void done(PointTableRef table);
-    void crop(const BOX2D& box, PointView& input, PointView& output);
-    void crop(const GeomPkg& g, PointView& input, PointView& output);
+    void crop(const BOX2D& box, PointView& input, PointSelection& sel);
+    void crop(const GeomPkg& g, PointView& input, PointSelection& sel);
 #ifdef PDAL_HAVE_GEOS
     GEOSGeometry *validatePolygon(const std::string& poly);
     void preparePolygon(GeomPkg& g);
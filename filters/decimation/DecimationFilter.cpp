@@ -56,21 +56,20 @@ void DecimationFilter::processOptions(const Options& options)
 }
 
 
-PointViewSet DecimationFilter::run(PointViewPtr inView)
+// The points this filter would be given as a view are the ones still
+// selected, so positions are counted among those.
+void DecimationFilter::select(PointView& /*view*/, PointSelection& sel)
 {
-    PointViewSet viewSet;
-    PointViewPtr outView = inView->makeNew();
-    decimate(*inView.get(), *outView.get());
-    viewSet.insert(outView);
-    return viewSet;
-}
-
-
-void DecimationFilter::decimate(PointView& input, PointView& output)
-{
-    PointId last_idx = (m_limit > 0) ? m_limit : input.size();
-    for (PointId idx = m_offset; idx < last_idx; idx += m_step)
-        output.appendPoint(input, idx);
+    PointId last = (m_limit > 0) ? m_limit : sel.count();
+    PointId keep = m_offset;
+    PointId pos = 0;
+    for (PointId idx = sel.first(); idx < sel.size(); idx = sel.next(idx))
+    {
+        if (pos++ == keep && keep < last)
+            keep += m_step;
+        else
+            sel.clear(idx);
+    }
 }
 
 } // pdal
@@ -52,6 +52,15 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims.clear();
+        return true;
+    }
+    virtual bool threadSafe() const
+        { return true; }
+    virtual bool selects() const
+        { return true; }
 
 private:
     uint32_t m_step;
@@ -59,8 +68,7 @@ private:
     point_count_t m_limit;
 
     virtual void processOptions(const Options& options);
-    PointViewSet run(PointViewPtr view);
-    void decimate(PointView& input, PointView& output);
+    virtual void select(PointView& view, PointSelection& sel);
 
     DecimationFilter& operator=(const DecimationFilter&); // not implemented
     DecimationFilter(const DecimationFilter&); // not implemented
@@ -103,11 +103,13 @@ void FerryFilter::addDimensions(PointLayoutPtr layout)
 void FerryFilter::ready(PointTableRef table)
 {
     const PointLayoutPtr layout(table.layout());
+    m_dimensions.clear();
     for (const auto& dim_par : m_name_map)
     {
         Dimension::Id::Enum f = layout->findDim(dim_par.first);
         Dimension::Id::Enum t = layout->findDim(dim_par.second);
-        m_dimensions_map.insert(std::make_pair(f,t));
+        m_dimensions.push_back(DimPair(DimAccessor<double>(layout, f),
+            DimAccessor<double>(layout, t)));
     }
 }
 
@@ -116,10 +118,10 @@ void FerryFilter::filter(PointView& view)
 {
     for (PointId id = 0; id < view.size(); ++id)
     {
-        for (const auto& dim_par : m_dimensions_map)
+        for (const auto& dim_par : m_dimensions)
         {
-            double v = view.getFieldAs<double>(dim_par.first, id);
-            view.setField(dim_par.second, id, v);
+            double v = dim_par.first.get(view, id);
+            dim_par.second.set(view, id, v);
         }
     }
 }
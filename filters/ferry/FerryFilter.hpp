@@ -34,10 +34,12 @@
 
 #pragma once
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 
 #include <map>
 #include <string>
+#include <vector>
 
 extern "C" int32_t FerryFilter_ExitFunc();
 extern "C" PF_ExitFunc FerryFilter_InitPlugin();
@@ -56,6 +58,10 @@ public:
     std::string getName() const;
 
     Options getDefaultOptions();
+    virtual bool streamable() const
+        { return true; }
+    virtual bool threadSafe() const
+        { return true; }
 
 private:
     virtual void processOptions(const Options&);
@@ -67,7 +73,8 @@ private:
     FerryFilter(const FerryFilter&); // not implemented
 
     std::map<std::string, std::string> m_name_map;
-    std::map< Dimension::Id::Enum ,  Dimension::Id::Enum > m_dimensions_map;
+    typedef std::pair<DimAccessor<double>, DimAccessor<double>> DimPair;
+    std::vector<DimPair> m_dimensions;
 };
 
 } // namespace pdal
@@ -51,6 +51,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims.clear();
+        return true;
+    }
 
 private:
     PointViewPtr m_view;
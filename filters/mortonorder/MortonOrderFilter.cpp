@@ -34,9 +34,8 @@
 
 #include "MortonOrderFilter.hpp"
 
-#include <iostream>
-#include <limits>
-#include <map>
+#include <pdal/GlobalEnvironment.hpp>
+#include <pdal/util/Utils.hpp>
 
 namespace pdal
 {
@@ -53,76 +52,57 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 Options MortonOrderFilter::getDefaultOptions()
 {
     Options options;
+    options.add("curve", "morton", "Curve to order points along: morton, "
+        "hilbert or morton3d");
     return options;
 }
 
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
+// Dimensions are collected before options are processed, so the curve is
+// read from the options here.
+bool MortonOrderFilter::usedDims(StringList& dims) const
 {
-bool less_msb(const int& x, const int& y)
-{
-    return x < y && x < (x ^ y);
-};
-
-class CmpZOrder
-{
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
-
-        int j = 0;
-        int x = 0;
-
-        for (int k = 0; k < 2; k++)
-        {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
-            {
-                j = k;
-                x = y;
-            }
-        }
-        return (a[j] - b[j]) < 0;
-    };
-};
+    std::string curve = Utils::tolower(
+        getOptions().getValueOrDefault<std::string>("curve", "morton"));
+    dims = { "X", "Y" };
+    if (curve == "morton3d")
+        dims.push_back("Z");
+    return true;
 }
 
-PointViewSet MortonOrderFilter::run(PointViewPtr inView)
-{
-    PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
 
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
-
-    for (PointId idx = 0; idx < inView->size(); idx++)
+void MortonOrderFilter::processOptions(const Options& options)
+{
+    std::string curve = Utils::tolower(
+        options.getValueOrDefault<std::string>("curve", "morton"));
+    if (curve == "morton")
+        m_curve = SortKey::Morton;
+    else if (curve == "hilbert")
+        m_curve = SortKey::Hilbert;
+    else if (curve == "morton3d")
+        m_curve = SortKey::Morton3d;
+    else
     {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
+        std::ostringstream oss;
+        oss << getName() << ": Invalid curve '" << curve << "'.  Must be "
+            "'morton', 'hilbert' or 'morton3d'.";
+        throw pdal_error(oss.str());
     }
+}
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
-    {
-        outView->appendPoint(*inView, pos->second);
-    }
-    viewSet.insert(outView);
 
-    return viewSet;
+// Each point's position along the curve, within the bounds of the view,
+// is computed once and the positions are radix sorted.
+void MortonOrderFilter::filter(PointView& view)
+{
+    if (view.size() < 2)
+        return;
+
+    BOX3D bounds;
+    view.calculateBounds(bounds);
+    PointSorter sorter({ SortKey(m_curve, bounds) },
+        GlobalEnvironment::get().threadPool());
+    sorter.sort(view);
 }
 
 } // pdal
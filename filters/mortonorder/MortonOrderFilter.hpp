@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/PointSort.hpp>
 
 extern "C" int32_t MortonOrderFilter_ExitFunc();
 extern "C" PF_ExitFunc MortonOrderFilter_InitPlugin();
@@ -45,18 +46,21 @@ namespace pdal
 class PDAL_DLL MortonOrderFilter : public pdal::Filter
 {
 public:
-    MortonOrderFilter()
+    MortonOrderFilter() : m_curve(SortKey::Morton)
     {}
 
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const;
 
     Options getDefaultOptions();
 
 private:
-    virtual void processOptions(const Options& ) {};
-    virtual PointViewSet run(PointViewPtr view);
+    SortKey::Type m_curve;
+
+    virtual void processOptions(const Options& options);
+    virtual void filter(PointView& view);
 
     MortonOrderFilter& operator=(const MortonOrderFilter&); // not implemented
     MortonOrderFilter(const MortonOrderFilter&); // not implemented
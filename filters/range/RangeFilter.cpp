@@ -53,8 +53,46 @@ CREATE_STATIC_PLUGIN(1, 0, RangeFilter, Filter, s_info)
 
 std::string RangeFilter::getName() const { return s_info.name; }
 
+bool RangeFilter::usedDims(StringList& dims) const
+{
+    dims.clear();
+    for (auto const& d : getOptions().getOptions("dimension"))
+        dims.push_back(d.getValue<std::string>());
+    return true;
+}
+
+
+bool RangeFilter::predicates(DimPredicateList& preds) const
+{
+    std::map<std::string, Range> ranges;
+    try
+    {
+        ranges = parseRanges(getOptions());
+    }
+    catch (pdal_error&)
+    {
+        return false;
+    }
+
+    // Values that aren't numbers are never outside a range.
+    for (auto const& r : ranges)
+        preds.push_back(DimPredicate(r.first, r.second.min, r.second.max,
+            true));
+    return true;
+}
+
+
 void RangeFilter::processOptions(const Options& options)
 {
+    m_name_map = parseRanges(options);
+}
+
+
+std::map<std::string, Range> RangeFilter::parseRanges(
+    const Options& options) const
+{
+    std::map<std::string, Range> ranges;
+
     std::vector<Option> dimensions = options.getOptions("dimension");
     if (dimensions.size() == 0)
         throw pdal_error("No dimensions given");
@@ -80,49 +118,38 @@ void RangeFilter::processOptions(const Options& options)
         range.min = min;
         range.max = max;
 
-        m_name_map.insert(std::make_pair(name, range));
+        ranges.insert(std::make_pair(name, range));
     }
+    return ranges;
 }
 
 void RangeFilter::ready(PointTableRef table)
 {
     const PointLayoutPtr layout(table.layout());
+    m_ranges.clear();
     for (auto const& d : m_name_map)
     {
-        m_dimensions_map.insert(
-                std::make_pair(
-                    layout->findDim(d.first),
-                    d.second));
+        DimRange r;
+        r.m_dim.init(layout, layout->findDim(d.first));
+        r.m_range = d.second;
+        m_ranges.push_back(r);
     }
 }
 
-PointViewSet RangeFilter::run(PointViewPtr inView)
+// Check one dimension at a time, so each pass is a tight loop over the
+// points that passed the ranges before it.
+void RangeFilter::select(PointView& view, PointSelection& sel)
 {
-    PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
+    if (predicatesPushed())
+        return;
 
-    PointViewPtr outView = inView->makeNew();
-
-    for (PointId i = 0; i < inView->size(); ++i)
-    {
-        bool keep_point = true;
-        for (auto const& d : m_dimensions_map)
+    for (auto const& r : m_ranges)
+        for (PointId i = sel.first(); i < sel.size(); i = sel.next(i))
         {
-            double v = inView->getFieldAs<double>(d.first, i);
-            if (v < d.second.min || v > d.second.max)
-            {
-                keep_point = false;
-                break;
-            }
+            double v = r.m_dim.get(view, i);
+            if (v < r.m_range.min || v > r.m_range.max)
+                sel.clear(i);
         }
-        if (keep_point)
-            outView->appendPoint(*inView, i);
-    }
-
-    viewSet.insert(outView);
-
-    return viewSet;
 }
 
 } // pdal
@@ -34,11 +34,13 @@
 
 #pragma once
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 
 #include <memory>
 #include <map>
 #include <string>
+#include <vector>
 
 extern "C" int32_t RangeFilter_ExitFunc();
 extern "C" PF_ExitFunc RangeFilter_InitPlugin();
@@ -63,14 +65,31 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const;
+    virtual bool predicates(DimPredicateList& preds) const;
+    virtual bool streamable() const
+        { return true; }
+    virtual bool threadSafe() const
+        { return true; }
+    virtual bool selects() const
+        { return true; }
+    virtual bool dropsEmptyViews() const
+        { return true; }
 
 private:
+    struct DimRange
+    {
+        DimAccessor<double> m_dim;
+        Range m_range;
+    };
+
     std::map<std::string, Range> m_name_map;
-    std::map<Dimension::Id::Enum, Range> m_dimensions_map;
+    std::vector<DimRange> m_ranges;
 
+    std::map<std::string, Range> parseRanges(const Options& options) const;
     virtual void processOptions(const Options&options);
     virtual void ready(PointTableRef table);
-    virtual PointViewSet run(PointViewPtr view);
+    virtual void select(PointView& view, PointSelection& sel);
 
     RangeFilter& operator=(const RangeFilter&); // not implemented
     RangeFilter(const RangeFilter&); // not implemented
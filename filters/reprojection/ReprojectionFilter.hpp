@@ -58,6 +58,13 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y", "Z" };
+        return true;
+    }
+    virtual bool streamable() const
+        { return true; }
 
 private:
     virtual void processOptions(const Options& options);
@@ -34,6 +34,9 @@
 
 #include "SortFilter.hpp"
 
+#include <pdal/GlobalEnvironment.hpp>
+#include <pdal/util/Utils.hpp>
+
 namespace pdal
 {
 
@@ -46,5 +49,65 @@ CREATE_STATIC_PLUGIN(1, 0, SortFilter, Filter, s_info)
 
 std::string SortFilter::getName() const { return s_info.name; }
 
+
+void SortFilter::processOptions(const Options& options)
+{
+    m_dimNames = options.getValues<std::string>("dimension");
+    if (m_dimNames.empty())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'dimension' must be specified.";
+        throw pdal_error(oss.str());
+    }
+
+    // A single order applies to every dimension.  Otherwise there's one
+    // for each dimension.
+    StringList orders = options.getValues<std::string>("order");
+    if (orders.size() > 1 && orders.size() != m_dimNames.size())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'order' must be given once or once "
+            "for each dimension.";
+        throw pdal_error(oss.str());
+    }
+    m_descending.clear();
+    for (size_t i = 0; i < m_dimNames.size(); ++i)
+    {
+        std::string order = orders.empty() ? "ASC" :
+            Utils::toupper(orders[orders.size() == 1 ? 0 : i]);
+        if (order != "ASC" && order != "DESC")
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Invalid order '" << order <<
+                "'.  Must be 'ASC' or 'DESC'.";
+            throw pdal_error(oss.str());
+        }
+        m_descending.push_back(order == "DESC");
+    }
+}
+
+
+// Dimensions that aren't in the layout are skipped.
+void SortFilter::ready(PointTableRef table)
+{
+    m_keys.clear();
+    for (size_t i = 0; i < m_dimNames.size(); ++i)
+    {
+        Dimension::Id::Enum dim = table.layout()->findDim(m_dimNames[i]);
+        if (dim != Dimension::Id::Unknown)
+            m_keys.push_back(SortKey(dim, m_descending[i]));
+    }
+}
+
+
+void SortFilter::filter(PointView& view)
+{
+    if (m_keys.empty())
+        return;
+
+    PointSorter sorter(m_keys, GlobalEnvironment::get().threadPool());
+    sorter.sort(view);
+}
+
 } // namespace pdal
 
@@ -35,7 +35,7 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
-#include <pdal/PointViewIter.hpp>
+#include <pdal/PointSort.hpp>
 
 extern "C" int32_t SortFilter_ExitFunc();
 extern "C" PF_ExitFunc SortFilter_InitPlugin();
@@ -52,29 +52,22 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
-
-private:
-    // Dimension on which to sort.
-    Dimension::Id::Enum m_dim;
-    // Dimension name.
-    std::string m_dimName;
-
-    virtual void processOptions(const Options& options)
-        { m_dimName = options.getValueOrThrow<std::string>("dimension"); }
-
-    virtual void ready(PointTableRef table)
-        { m_dim = table.layout()->findDim(m_dimName); }
-
-    virtual void filter(PointView& view)
+    virtual bool usedDims(StringList& dims) const
     {
-        if (m_dim == Dimension::Id::Unknown)
-            return;
+        dims = getOptions().getValues<std::string>("dimension");
+        return true;
+    }
 
-        auto cmp = [this](const PointRef& p1, const PointRef& p2)
-            { return p1.compare(m_dim, p2); };
+private:
+    // Dimension names, most significant first.
+    StringList m_dimNames;
+    // Whether each dimension is sorted in decreasing order.
+    std::vector<bool> m_descending;
+    SortKeyList m_keys;
 
-        std::sort(view.begin(), view.end(), cmp);
-    }
+    virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
+    virtual void filter(PointView& view);
 
     SortFilter& operator=(const SortFilter&); // not implemented
     SortFilter(const SortFilter&); // not implemented
@@ -62,6 +62,13 @@ void SplitterFilter::processOptions(const Options& options)
 }
 
 
+void SplitterFilter::ready(PointTableRef table)
+{
+    m_x.init(table.layout(), Dimension::Id::X);
+    m_y.init(table.layout(), Dimension::Id::Y);
+}
+
+
 Options SplitterFilter::getDefaultOptions()
 {
     Options options;
@@ -101,17 +108,17 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
     // Use the location of the first point as the origin, unless specified.
     // (!= test == isnan(), which doesn't exist on windows)
     if (m_xOrigin != m_xOrigin)
-        m_xOrigin = inView->getFieldAs<double>(Dimension::Id::X, 0);
+        m_xOrigin = m_x.get(*inView, 0);
     if (m_yOrigin != m_yOrigin)
-        m_yOrigin = inView->getFieldAs<double>(Dimension::Id::Y, 0);
+        m_yOrigin = m_y.get(*inView, 0);
     // Overlay a grid of squares on the points (m_length sides).  Each square
     // corresponds to a new point buffer.  Place the points falling in the
     // each square in the corresponding point buffer.
     for (PointId idx = 0; idx < inView->size(); idx++)
     {
-        double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
+        double x = m_x.get(*inView, idx);
         int xpos = (x - m_xOrigin) / m_length;
-        double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
+        double y = m_y.get(*inView, idx);
         int ypos = (y - m_yOrigin) / m_length;
 
         Coord loc(xpos, ypos);
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 
 extern "C" int32_t SplitterFilter_ExitFunc();
@@ -51,6 +52,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y" };
+        return true;
+    }
 
     Options getDefaultOptions();
 
@@ -58,8 +64,11 @@ private:
     double m_length;
     double m_xOrigin;
     double m_yOrigin;
+    DimAccessor<double> m_x;
+    DimAccessor<double> m_y;
 
     virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
     SplitterFilter& operator=(const SplitterFilter&); // not implemented
@@ -83,14 +83,8 @@ using namespace stats;
 void StatsFilter::filter(PointView& view)
 {
     for (PointId idx = 0; idx < view.size(); ++idx)
-    {
-        for (auto p = m_stats.begin(); p != m_stats.end(); ++p)
-        {
-            Dimension::Id::Enum d = p->first;
-            Summary& c = p->second;
-            c.insert(view.getFieldAs<double>(d, idx));
-        }
-    }
+        for (auto& a : m_accessors)
+            a.second->insert(a.first.get(view, idx));
 }
 
 
@@ -100,6 +94,20 @@ void StatsFilter::done(PointTableRef table)
 }
 
 
+bool StatsFilter::usedDims(StringList& dims) const
+{
+    // Without a list of dimensions, statistics are computed for all of them.
+    dims = getOptions().getValueOrDefault<StringList>("dimensions");
+    if (dims.empty())
+        return false;
+    for (auto& name : getOptions().getValueOrDefault<StringList>("enumerate"))
+        dims.push_back(name);
+    for (auto& name : getOptions().getValueOrDefault<StringList>("count"))
+        dims.push_back(name);
+    return true;
+}
+
+
 void StatsFilter::processOptions(const Options& options)
 {
     m_dimNames = options.getValueOrDefault<StringList>("dimensions");
@@ -169,6 +177,15 @@ void StatsFilter::prepared(PointTableRef table)
         m_stats.insert(std::make_pair(layout->findDim(dv.first),
             Summary(dv.first, dv.second)));
 }
+
+
+void StatsFilter::ready(PointTableRef table)
+{
+    m_accessors.clear();
+    for (auto& s : m_stats)
+        m_accessors.push_back(std::make_pair(
+            DimAccessor<double>(table.layout(), s.first), &s.second));
+}
     
 
 void StatsFilter::extractMetadata()
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 
 extern "C" int32_t StatsFilter_ExitFunc();
@@ -117,6 +118,7 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const;
 
     const stats::Summary& getStats(Dimension::Id::Enum d) const;
     void reset();
@@ -126,6 +128,7 @@ private:
     StatsFilter(const StatsFilter&); // not implemented
     virtual void processOptions(const Options& options);
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
     virtual void done(PointTableRef table);
     virtual void filter(PointView& view);
     void extractMetadata();
@@ -134,6 +137,7 @@ private:
     StringList m_enums;
     StringList m_counts;
     std::map<Dimension::Id::Enum, stats::Summary> m_stats;
+    std::vector<std::pair<DimAccessor<double>, stats::Summary *>> m_accessors;
 };
 
 } // namespace pdal
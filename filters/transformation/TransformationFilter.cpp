@@ -90,21 +90,31 @@ void TransformationFilter::processOptions(const Options& options)
 }
 
 
+void TransformationFilter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+
+    m_x.init(layout, Dimension::Id::X);
+    m_y.init(layout, Dimension::Id::Y);
+    m_z.init(layout, Dimension::Id::Z);
+}
+
+
 void TransformationFilter::filter(PointView& view)
 {
     for (PointId idx = 0; idx < view.size(); ++idx)
     {
-        double x = view.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, idx);
+        double x = m_x.get(view, idx);
+        double y = m_y.get(view, idx);
+        double z = m_z.get(view, idx);
 
-        view.setField(Dimension::Id::X, idx,
+        m_x.set(view, idx,
             x * m_matrix[0] + y * m_matrix[1] + z * m_matrix[2] + m_matrix[3]);
 
-        view.setField(Dimension::Id::Y, idx,
+        m_y.set(view, idx,
             x * m_matrix[4] + y * m_matrix[5] + z * m_matrix[6] + m_matrix[7]);
 
-        view.setField(Dimension::Id::Z, idx,
+        m_z.set(view, idx,
             x * m_matrix[8] + y * m_matrix[9] + z * m_matrix[10] + m_matrix[11]);
     }
 }
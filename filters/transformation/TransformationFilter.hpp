@@ -37,6 +37,7 @@
 #include <array>
 #include <string>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/pdal_export.hpp>
 
@@ -63,14 +64,27 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y", "Z" };
+        return true;
+    }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool threadSafe() const
+        { return true; }
 
 private:
     TransformationFilter& operator=(const TransformationFilter&); // not implemented
     TransformationFilter(const TransformationFilter&); // not implemented
     virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
 
     TransformationMatrix m_matrix;
+    DimAccessor<double> m_x;
+    DimAccessor<double> m_y;
+    DimAccessor<double> m_z;
 };
 
 
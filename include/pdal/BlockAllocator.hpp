@@ -0,0 +1,99 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+// Provides the memory for the blocks of points held by a point table.
+class PDAL_DLL BlockAllocator
+{
+public:
+    virtual ~BlockAllocator()
+        {}
+
+    // Allocate a block of 'size' bytes, filled with zeros if 'zero' is
+    // true.  Throws pdal_error if the memory isn't available.
+    virtual char *allocate(std::size_t size, bool zero) = 0;
+    // Return a block obtained from allocate() with the same size.
+    virtual void release(char *buf, std::size_t size) = 0;
+
+    // The allocator used by point tables unless another is provided.  It
+    // gets memory from the heap and returns it on release.
+    static BlockAllocator& heap();
+};
+
+
+// Allocator that keeps released blocks on a free list, by size, so that
+// later tables can reuse them without going back to the system and
+// faulting in fresh pages.  Blocks can optionally be backed by huge pages
+// (where the OS supports it), which reduces TLB pressure for large tables.
+// An allocator can be shared by tables on different threads.
+class PDAL_DLL PoolAllocator : public BlockAllocator
+{
+public:
+    // 'maxPooled' limits the bytes kept on the free lists (0 = no limit).
+    PoolAllocator(std::size_t maxPooled = 0, bool hugePages = false);
+    ~PoolAllocator();
+
+    virtual char *allocate(std::size_t size, bool zero);
+    virtual void release(char *buf, std::size_t size);
+
+    // Give all pooled blocks back to the system.
+    void clear();
+    // Number of bytes currently held on the free lists.
+    std::size_t pooledBytes() const;
+
+private:
+    std::map<std::size_t, std::vector<char *>> m_free;
+    std::size_t m_pooled;
+    std::size_t m_maxPooled;
+    bool m_hugePages;
+    mutable std::mutex m_mutex;
+
+    char *systemAllocate(std::size_t size, bool& zeroed);
+    void systemRelease(char *buf, std::size_t size);
+
+    PoolAllocator& operator=(const PoolAllocator&); // not implemented
+    PoolAllocator(const PoolAllocator&); // not implemented
+};
+
+} // namespace pdal
@@ -0,0 +1,281 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/PointView.hpp>
+
+#include <cstring>
+#include <sstream>
+
+namespace pdal
+{
+
+/// Typed access to a single dimension of the points in a view.  The type,
+/// offset and size of the dimension's storage are resolved once, when the
+/// accessor is initialized, instead of on every access as with
+/// PointView::getFieldAs() and PointView::setField().  For tables that
+/// store packed point records in blocks (PointTable and the tables derived
+/// from it), an access finds the point's record from the view's index and
+/// does a typed load or store at the dimension's offset, with no virtual
+/// call.  Other tables, and points being appended, go through the table's
+/// getField()/setField().  Values are range-checked as with
+/// getFieldAs()/setField().  Accessors must be initialized after the layout
+/// has been finalized (in a stage's ready() function, for example).
+template<typename T>
+class DimAccessor
+{
+public:
+    DimAccessor() : m_detail(NULL), m_type(Dimension::Type::None),
+        m_offset(0), m_pointSize(0)
+        {}
+    DimAccessor(PointLayoutPtr layout, Dimension::Id::Enum id)
+        { init(layout, id); }
+
+    void init(PointLayoutPtr layout, Dimension::Id::Enum id);
+
+    T get(const PointView& view, PointId idx) const
+    {
+        using namespace Dimension;
+
+        const char *pos = address(view, idx);
+        switch (m_type)
+        {
+        case Type::Float:
+            return getAs<float>(view, idx, pos);
+        case Type::Double:
+            return getAs<double>(view, idx, pos);
+        case Type::Signed8:
+            return getAs<int8_t>(view, idx, pos);
+        case Type::Signed16:
+            return getAs<int16_t>(view, idx, pos);
+        case Type::Signed32:
+            return getAs<int32_t>(view, idx, pos);
+        case Type::Signed64:
+            return getAs<int64_t>(view, idx, pos);
+        case Type::Unsigned8:
+            return getAs<uint8_t>(view, idx, pos);
+        case Type::Unsigned16:
+            return getAs<uint16_t>(view, idx, pos);
+        case Type::Unsigned32:
+            return getAs<uint32_t>(view, idx, pos);
+        case Type::Unsigned64:
+            return getAs<uint64_t>(view, idx, pos);
+        case Type::None:
+        default:
+            return T(0);
+        }
+    }
+
+    void set(PointView& view, PointId idx, T val) const
+    {
+        using namespace Dimension;
+
+        char *pos = address(view, idx);
+        switch (m_type)
+        {
+        case Type::Float:
+            setAs<float>(view, idx, pos, val);
+            break;
+        case Type::Double:
+            setAs<double>(view, idx, pos, val);
+            break;
+        case Type::Signed8:
+            setAs<int8_t>(view, idx, pos, val);
+            break;
+        case Type::Signed16:
+            setAs<int16_t>(view, idx, pos, val);
+            break;
+        case Type::Signed32:
+            setAs<int32_t>(view, idx, pos, val);
+            break;
+        case Type::Signed64:
+            setAs<int64_t>(view, idx, pos, val);
+            break;
+        case Type::Unsigned8:
+            setAs<uint8_t>(view, idx, pos, val);
+            break;
+        case Type::Unsigned16:
+            setAs<uint16_t>(view, idx, pos, val);
+            break;
+        case Type::Unsigned32:
+            setAs<uint32_t>(view, idx, pos, val);
+            break;
+        case Type::Unsigned64:
+            setAs<uint64_t>(view, idx, pos, val);
+            break;
+        case Type::None:
+        default:
+            break;
+        }
+    }
+
+    /// Set the values of a run of packed point records, such as one got
+    /// from PointView::getSpan() or PointView::appendSpan().
+    /// \param buf    Address of the first record.
+    /// \param count  Number of records.
+    /// \param vals   A value for each record.
+    void setSpan(char *buf, point_count_t count, const T *vals) const
+    {
+        using namespace Dimension;
+
+        switch (m_type)
+        {
+        case Type::Float:
+            setSpanAs<float>(buf, count, vals);
+            break;
+        case Type::Double:
+            setSpanAs<double>(buf, count, vals);
+            break;
+        case Type::Signed8:
+            setSpanAs<int8_t>(buf, count, vals);
+            break;
+        case Type::Signed16:
+            setSpanAs<int16_t>(buf, count, vals);
+            break;
+        case Type::Signed32:
+            setSpanAs<int32_t>(buf, count, vals);
+            break;
+        case Type::Signed64:
+            setSpanAs<int64_t>(buf, count, vals);
+            break;
+        case Type::Unsigned8:
+            setSpanAs<uint8_t>(buf, count, vals);
+            break;
+        case Type::Unsigned16:
+            setSpanAs<uint16_t>(buf, count, vals);
+            break;
+        case Type::Unsigned32:
+            setSpanAs<uint32_t>(buf, count, vals);
+            break;
+        case Type::Unsigned64:
+            setSpanAs<uint64_t>(buf, count, vals);
+            break;
+        case Type::None:
+        default:
+            break;
+        }
+    }
+
+private:
+    const Dimension::Detail *m_detail;
+    Dimension::Type::Enum m_type;
+    std::size_t m_offset;
+    std::size_t m_pointSize;
+
+    // The address of the value of point 'idx', or NULL if it has to be
+    // accessed through the table.
+    char *address(const PointView& view, PointId idx) const
+    {
+        if (idx >= view.size())
+            return NULL;
+        char *pos = view.m_pointTable.rowPoint(view.m_index[idx],
+            m_pointSize);
+        return pos ? pos + m_offset : NULL;
+    }
+
+    template<typename SRC>
+    T getAs(const PointView& view, PointId idx, const char *pos) const
+    {
+        SRC s;
+        T t;
+
+        if (pos)
+            std::memcpy(&s, pos, sizeof(s));
+        else
+            view.getFieldInternal(m_detail, idx, &s);
+        if (!Utils::numericCast(s, t))
+            throwGet((double)s);
+        return t;
+    }
+
+    template<typename DST>
+    void setAs(PointView& view, PointId idx, char *pos, T val) const
+    {
+        DST t;
+
+        if (!Utils::numericCast(val, t))
+            throwSet((double)val);
+        if (pos)
+            std::memcpy(pos, &t, sizeof(t));
+        else
+            view.setFieldInternal(m_detail, idx, &t);
+    }
+
+    template<typename DST>
+    void setSpanAs(char *buf, point_count_t count, const T *vals) const
+    {
+        buf += m_offset;
+        for (point_count_t i = 0; i < count; ++i, buf += m_pointSize)
+        {
+            DST t;
+
+            if (!Utils::numericCast(vals[i], t))
+                throwSet((double)vals[i]);
+            std::memcpy(buf, &t, sizeof(t));
+        }
+    }
+
+    void throwGet(double val) const
+    {
+        std::ostringstream oss;
+        oss << "Unable to fetch data and convert as requested: ";
+        oss << Dimension::name(m_detail->id()) << ":" <<
+            Dimension::interpretationName(m_detail->type()) <<
+            "(" << val << ") -> " << Utils::typeidName<T>();
+        throw pdal_error(oss.str());
+    }
+
+    void throwSet(double val) const
+    {
+        std::ostringstream oss;
+        oss << "Unable to set data and convert as requested: ";
+        oss << Dimension::name(m_detail->id()) << ":" <<
+            Utils::typeidName<T>() << "(" << val << ") -> " <<
+            Dimension::interpretationName(m_detail->type());
+        throw pdal_error(oss.str());
+    }
+};
+
+
+template<typename T>
+void DimAccessor<T>::init(PointLayoutPtr layout, Dimension::Id::Enum id)
+{
+    m_detail = layout->dimDetail(id);
+    m_type = layout->dimType(id);
+    m_offset = m_detail->offset();
+    m_pointSize = layout->pointSize();
+}
+
+} // namespace pdal
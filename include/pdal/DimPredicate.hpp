@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Dimension.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+
+// A condition that a point's value for a dimension lies within a closed
+// range.  Filters that only drop points describe themselves with these so
+// that readers can check them before a point is stored.
+struct PDAL_DLL DimPredicate
+{
+    DimPredicate(const std::string& name, double min, double max,
+            bool passNan = false) :
+        m_name(name), m_id(Dimension::id(name)), m_min(min), m_max(max),
+        m_passNan(passNan)
+    {}
+
+    std::string m_name;
+    Dimension::Id::Enum m_id;
+    double m_min;
+    double m_max;
+    // Whether a value that isn't a number meets the condition.
+    bool m_passNan;
+
+    bool passes(double v) const
+    {
+        if (std::isnan(v))
+            return m_passNan;
+        return m_min <= v && v <= m_max;
+    }
+};
+typedef std::vector<DimPredicate> DimPredicateList;
+
+// Check that all predicates pass, using 'value' to fetch the value of a
+// dimension of the point being tested.
+template<typename VALUE>
+bool passes(const DimPredicateList& preds, VALUE value)
+{
+    for (const DimPredicate& p : preds)
+        if (!p.passes(value(p.m_id)))
+            return false;
+    return true;
+}
+
+} // namespace pdal
@@ -66,6 +66,13 @@ private:
     virtual PointViewSet run(PointViewPtr view)
     {
         PointViewSet viewSet;
+        if (selects())
+        {
+            PointViewPtr out = runSelection({ this }, view);
+            if (out)
+                viewSet.insert(out);
+            return viewSet;
+        }
         filter(*view);
         viewSet.insert(view);
         return viewSet;
@@ -40,6 +40,12 @@ namespace pdal
 
 class PDAL_DLL FlexWriter : public Writer
 {
+public:
+    // Points can be appended a chunk at a time as long as they all go
+    // to one file and the scale/offset needn't be computed from the data.
+    virtual bool streamable() const
+        { return m_hashPos == std::string::npos && !hasAutoXForm(); }
+
 protected:
     FlexWriter() : m_hashPos(std::string::npos), m_filenum(1)
     {}
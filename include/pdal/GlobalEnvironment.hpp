@@ -51,6 +51,8 @@ namespace gdal
 class ErrorHandler;
 }
 
+class ThreadPool;
+
 class PDAL_DLL GlobalEnvironment
 {
 public:
@@ -65,11 +67,37 @@ public:
 
     void initializeGDAL(LogPtr log, bool bGDALDebugOutput=false);
 
+    // Set the number of threads in the process-wide thread pool.  Zero
+    // means one per hardware thread.
+    void setThreads(size_t numThreads);
+    // Get the process-wide thread pool, or NULL if work should be done
+    // on the calling thread.
+    ThreadPool *threadPool();
+    // Set the most input branches of a stage that execute at once, each
+    // with its own point table.  Zero, the default, means one per thread
+    // in the pool.
+    void setMaxBranches(size_t maxBranches)
+        { m_maxBranches = maxBranches; }
+    size_t maxBranches() const
+        { return m_maxBranches; }
+
+    // Turn on recording of timings, point counts and table memory for
+    // each stage that is prepared afterwards.  See StageProfile.
+    void setProfiling(bool profiling)
+        { m_profiling = profiling; }
+    bool profiling() const
+        { return m_profiling; }
+
 private:
     GlobalEnvironment();
     ~GlobalEnvironment();
 
     std::unique_ptr<gdal::ErrorHandler> m_gdalDebug;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    size_t m_numThreads;
+    std::mutex m_poolMutex;
+    size_t m_maxBranches;
+    bool m_profiling;
 #ifdef PDAL_HAVE_PYTHON
     std::unique_ptr<plang::PythonEnvironment> m_pythonEnvironment;
 #endif
@@ -55,7 +55,8 @@ template<int DIM>
 class PDAL_DLL KDIndex
 {
 protected:
-    KDIndex(const PointView& buf) : m_buf(buf)
+    KDIndex(const PointView& buf) : m_buf(buf),
+        m_charge(buf.memory(), MemoryTracker::Index)
     {}
    
     ~KDIndex()
@@ -69,11 +70,20 @@ public:
     double kdtree_distance(const double *p1, const PointId p2_idx,
         size_t /*numDims*/) const;
     template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
+    // The index holds a point ID for each point and a node for every few
+    // points.  An estimate of that is charged before the index is built,
+    // and the actual amount once it's built.
     void build()
     {
+        const std::size_t LeafSize = 10;
+        const std::size_t count = m_buf.size();
+        m_charge.set(count * sizeof(std::size_t) +
+            (2 * count / LeafSize + 1) *
+            (2 * sizeof(void *) + 3 * sizeof(double)));
         m_index.reset(new my_kd_tree_t(DIM, *this,
-            nanoflann::KDTreeSingleIndexAdaptorParams(10, DIM)));
+            nanoflann::KDTreeSingleIndexAdaptorParams(LeafSize, DIM)));
         m_index->buildIndex();
+        m_charge.set(m_index->usedMemory());
     }
 
 protected:
@@ -83,6 +93,7 @@ protected:
         double, KDIndex, double>, KDIndex, -1, std::size_t> my_kd_tree_t;
 
     std::unique_ptr<my_kd_tree_t> m_index;
+    MemoryCharge m_charge;
 
 private:
     KDIndex(const KDIndex&);
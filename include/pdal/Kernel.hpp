@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/KernelSupport.hpp>
+#include <pdal/MemoryTracker.hpp>
 #include <pdal/pdal_export.hpp>
 
 #ifdef PDAL_COMPILER_MSVC
@@ -134,6 +135,11 @@ public:
             applyExtraStageOptionsRecursive(s);
     }
 
+    // Write the profiles recorded for the stages of the pipeline ending
+    // with 'stage' and, if 'memory' isn't null, its memory use, to standard
+    // error as JSON.
+    void writeReport(Stage *stage, MemoryTrackerPtr memory);
+
 protected:
     Stage& ownStage(Stage *s)
     {
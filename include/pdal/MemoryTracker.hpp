@@ -0,0 +1,159 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Metadata.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace pdal
+{
+
+// Bytes of memory in use, and the most that has been in use at once, for
+// the point data of a pipeline: table storage, the point indexes of views,
+// spatial indexes and large temporary buffers of stages.  A point table
+// owns a tracker that the views, indexes and stages built on the table
+// charge their memory to.  If a budget is set, a charge that would take
+// the total past it fails with pdal_error before the memory is allocated.
+class PDAL_DLL MemoryTracker
+{
+public:
+    enum Category
+    {
+        Table,
+        View,
+        Index,
+        StageData,
+        NumCategories
+    };
+
+    MemoryTracker();
+
+    // Limit on the total number of bytes in use.  Zero means no limit.
+    void setBudget(std::size_t bytes)
+        { m_budget = bytes; }
+    std::size_t budget() const
+        { return m_budget; }
+
+    // Note that 'bytes' more memory is about to be used for 'category'.
+    // Throws pdal_error, leaving the totals unchanged, if that would exceed
+    // the budget.  Thread-safe.
+    void allocate(Category category, std::size_t bytes);
+    // Note that 'bytes' of memory used for 'category' has been freed.
+    void release(Category category, std::size_t bytes);
+
+    std::size_t current() const
+        { return m_current[NumCategories]; }
+    std::size_t peak() const
+        { return m_peak[NumCategories]; }
+    std::size_t current(Category category) const
+        { return m_current[category]; }
+    std::size_t peak(Category category) const
+        { return m_peak[category]; }
+
+    // Add current and peak usage, overall and for each category, as a
+    // 'memory' child of 'parent'.
+    void write(MetadataNode parent) const;
+
+    static const char *categoryName(Category category);
+
+private:
+    // The last entry of each array holds the total for all categories.
+    std::atomic<std::size_t> m_current[NumCategories + 1];
+    std::atomic<std::size_t> m_peak[NumCategories + 1];
+    std::size_t m_budget;
+
+    static void raisePeak(std::atomic<std::size_t>& peak, std::size_t value);
+
+    MemoryTracker(const MemoryTracker&); // not implemented
+    MemoryTracker& operator=(const MemoryTracker&); // not implemented
+};
+typedef std::shared_ptr<MemoryTracker> MemoryTrackerPtr;
+
+
+// Memory charged to a tracker by the object that owns the charge.  The
+// owner sets the number of bytes it's using as that changes, and the charge
+// is released when the owner is destroyed.  A charge without a tracker
+// does nothing.  Copies start with the same tracker and nothing charged.
+class PDAL_DLL MemoryCharge
+{
+public:
+    MemoryCharge(MemoryTracker::Category category) : m_category(category),
+        m_bytes(0)
+        {}
+    MemoryCharge(MemoryTrackerPtr tracker, MemoryTracker::Category category) :
+        m_tracker(tracker), m_category(category), m_bytes(0)
+        {}
+    MemoryCharge(const MemoryCharge& other) : m_tracker(other.m_tracker),
+        m_category(other.m_category), m_bytes(0)
+        {}
+    ~MemoryCharge()
+        { set(0); }
+
+    // Release anything charged and charge to 'tracker' from now on.
+    void setTracker(MemoryTrackerPtr tracker)
+    {
+        set(0);
+        m_tracker = tracker;
+    }
+
+    // Set the number of bytes charged, allocating or releasing the
+    // difference.  Throws pdal_error if the tracker's budget would be
+    // exceeded.
+    void set(std::size_t bytes)
+    {
+        if (!m_tracker || bytes == m_bytes)
+            return;
+        if (bytes > m_bytes)
+            m_tracker->allocate(m_category, bytes - m_bytes);
+        else
+            m_tracker->release(m_category, m_bytes - bytes);
+        m_bytes = bytes;
+    }
+    std::size_t bytes() const
+        { return m_bytes; }
+
+private:
+    MemoryTrackerPtr m_tracker;
+    MemoryTracker::Category m_category;
+    std::size_t m_bytes;
+
+    MemoryCharge& operator=(const MemoryCharge&); // not implemented
+};
+
+} // namespace pdal
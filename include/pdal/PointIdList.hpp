@@ -0,0 +1,191 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/MemoryTracker.hpp>
+
+namespace pdal
+{
+
+// The point table IDs of the points in a view, in view order.  As long as
+// the IDs are consecutive (as they are for points read into a view by a
+// reader), only the first ID and the count are stored, so an entry costs
+// nothing and a lookup is an addition.  The IDs are expanded into a vector
+// the first time one is added or set out of sequence, which happens when a
+// filter subsets or reorders the points.
+class PDAL_DLL PointIdList
+{
+public:
+    PointIdList() : m_base(0), m_size(0), m_explicit(false),
+        m_charge(MemoryTracker::View)
+        {}
+    PointIdList(const PointIdList& other) : m_base(other.m_base),
+        m_size(other.m_size), m_explicit(other.m_explicit),
+        m_charge(other.m_charge)
+    {
+        grow(other.m_ids.size());
+        m_ids = other.m_ids;
+    }
+
+    // Charge the storage for expanded IDs to 'tracker'.
+    void track(MemoryTrackerPtr tracker)
+    {
+        m_charge.setTracker(tracker);
+        charge();
+    }
+
+    size_t size() const
+        { return m_explicit ? m_ids.size() : m_size; }
+    bool empty() const
+        { return size() == 0; }
+    // Whether the IDs are stored as a range rather than a vector.
+    bool isRange() const
+        { return !m_explicit; }
+
+    // Prepare for the list to hold 'count' IDs.  Storage is only needed
+    // once the list has been expanded.
+    void reserve(size_t count)
+    {
+        if (m_explicit)
+            grow(count);
+    }
+
+    PointId operator[](size_t pos) const
+        { return m_explicit ? m_ids[pos] : m_base + pos; }
+
+    void push_back(PointId id)
+    {
+        if (!m_explicit)
+        {
+            if (m_size == 0)
+                m_base = id;
+            if (id == m_base + m_size)
+            {
+                m_size++;
+                return;
+            }
+            expand();
+        }
+        if (m_ids.size() == m_ids.capacity())
+            grow((std::max)(m_ids.size() + 1, 2 * m_ids.capacity()));
+        m_ids.push_back(id);
+    }
+
+    void set(size_t pos, PointId id)
+    {
+        if (!m_explicit)
+        {
+            if (id == m_base + pos)
+                return;
+            expand();
+        }
+        m_ids[pos] = id;
+    }
+
+    // Remove all IDs and release the expanded storage.
+    void clear()
+    {
+        m_base = 0;
+        m_size = 0;
+        m_explicit = false;
+        std::vector<PointId>().swap(m_ids);
+        charge();
+    }
+
+    // Insert the first 'count' IDs of another list before position 'pos'.
+    void insert(size_t pos, const PointIdList& other, size_t count)
+    {
+        if (count == 0)
+            return;
+        if (!m_explicit && pos == m_size && other.isRange())
+        {
+            if (m_size == 0)
+                m_base = other.m_base;
+            if (other.m_base == m_base + m_size)
+            {
+                m_size += count;
+                return;
+            }
+        }
+        expand();
+        grow(m_ids.size() + count);
+        if (other.m_explicit)
+            m_ids.insert(m_ids.begin() + pos, other.m_ids.begin(),
+                other.m_ids.begin() + count);
+        else
+        {
+            m_ids.insert(m_ids.begin() + pos, count, 0);
+            for (size_t i = 0; i < count; ++i)
+                m_ids[pos + i] = other.m_base + i;
+        }
+    }
+
+private:
+    PointId m_base;
+    size_t m_size;
+    bool m_explicit;
+    std::vector<PointId> m_ids;
+    MemoryCharge m_charge;
+
+    void charge()
+        { m_charge.set(m_ids.capacity() * sizeof(PointId)); }
+
+    // Make room for at least 'count' IDs.  The storage is charged before
+    // it's allocated, so that if the budget is exceeded the list is left
+    // as it was.
+    void grow(size_t count)
+    {
+        if (count <= m_ids.capacity())
+            return;
+        m_charge.set(count * sizeof(PointId));
+        m_ids.reserve(count);
+    }
+
+    void expand()
+    {
+        if (m_explicit)
+            return;
+        grow(m_size + 1);
+        for (size_t i = 0; i < m_size; ++i)
+            m_ids.push_back(m_base + i);
+        m_explicit = true;
+    }
+};
+
+} // namespace pdal
@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+// The points of a view that a filter keeps, as a bitmap indexed by
+// position in the view.  All points start out selected.  Filters that only
+// drop points clear the ones they don't want (see Stage::select()), so a
+// chain of them can work on the same selection and make a single view at
+// the end with PointView::makeSubset() instead of one view per filter.
+class PDAL_DLL PointSelection
+{
+public:
+    PointSelection(point_count_t size = 0) : m_size(size), m_count(size),
+        m_words((size + 63) / 64, ~(uint64_t)0)
+    {
+        // Clear the bits past the end so that whole words can be scanned.
+        if (size % 64)
+            m_words.back() = ((uint64_t)1 << (size % 64)) - 1;
+    }
+
+    // Number of points in the view.
+    point_count_t size() const
+        { return m_size; }
+    // Number of points selected.
+    point_count_t count() const
+        { return m_count; }
+    bool all() const
+        { return m_count == m_size; }
+
+    bool selected(PointId idx) const
+        { return (m_words[idx / 64] >> (idx % 64)) & 1; }
+
+    void clear(PointId idx)
+    {
+        uint64_t& word = m_words[idx / 64];
+        uint64_t bit = (uint64_t)1 << (idx % 64);
+        if (word & bit)
+        {
+            word &= ~bit;
+            m_count--;
+        }
+    }
+
+    // Keep only the points selected in both.
+    PointSelection& operator&=(const PointSelection& other)
+    {
+        m_count = 0;
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            m_words[i] &= other.m_words[i];
+            m_count += popcount(m_words[i]);
+        }
+        return *this;
+    }
+
+    // The position of the first selected point, or size() if there are
+    // none.  Iterate with:
+    //   for (PointId i = sel.first(); i < sel.size(); i = sel.next(i))
+    PointId first() const
+        { return find(0); }
+    // The position of the next selected point after 'idx', or size().
+    PointId next(PointId idx) const
+        { return find(idx + 1); }
+
+private:
+    point_count_t m_size;
+    point_count_t m_count;
+    std::vector<uint64_t> m_words;
+
+    // Runs of cleared points are skipped a word at a time.
+    PointId find(PointId idx) const
+    {
+        size_t w = idx / 64;
+        if (w >= m_words.size())
+            return m_size;
+        uint64_t word = m_words[w] & (~(uint64_t)0 << (idx % 64));
+        while (!word)
+        {
+            if (++w == m_words.size())
+                return m_size;
+            word = m_words[w];
+        }
+        return w * 64 + lowestBit(word);
+    }
+
+    static int lowestBit(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int bit = 0;
+        while (!(word & 1))
+        {
+            word >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    static int popcount(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        int cnt = 0;
+        for (; word; cnt++)
+            word &= word - 1;
+        return cnt;
+#endif
+    }
+};
+
+} // namespace pdal
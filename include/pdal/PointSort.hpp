@@ -0,0 +1,120 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Dimension.hpp>
+#include <pdal/util/Bounds.hpp>
+
+#include <vector>
+
+namespace pdal
+{
+
+class PointView;
+class ThreadPool;
+
+// A dimension to sort points on and the direction, or a space-filling
+// curve to order points along.  Curves map X and Y (and Z for Morton3d)
+// within fixed bounds to a 64-bit position along the curve, so the order of
+// two points doesn't depend on which other points are sorted with them.
+struct SortKey
+{
+    enum Type
+    {
+        Dim,
+        Morton,
+        Hilbert,
+        Morton3d
+    };
+
+    SortKey(Dimension::Id::Enum dim, bool descending = false) :
+        m_type(Dim), m_dim(dim), m_descending(descending)
+    {}
+    SortKey(Type curve, const BOX3D& bounds) : m_type(curve),
+        m_dim(Dimension::Id::Unknown), m_descending(false), m_bounds(bounds)
+    {}
+    SortKey(Type curve, const BOX2D& bounds) : m_type(curve),
+        m_dim(Dimension::Id::Unknown), m_descending(false),
+        m_bounds(bounds.minx, bounds.miny, 0, bounds.maxx, bounds.maxy, 0)
+    {}
+
+    Type m_type;
+    Dimension::Id::Enum m_dim;
+    bool m_descending;
+    BOX3D m_bounds;
+};
+typedef std::vector<SortKey> SortKeyList;
+
+// Sorts the points of a view on one or more dimensions.  The values of each
+// key are copied out of the point table once, as integers that order the
+// same way as the values, along with the positions of their points, and
+// those pairs are put in order with an LSD radix sort.  Keys are sorted
+// from the last to the first, and since the radix sort is stable, points
+// end up in order of the first key, then the second and so on.  The view's
+// index is rearranged once at the end.  Points with equal keys keep their
+// order.
+class PDAL_DLL PointSorter
+{
+public:
+    // With a thread pool, large views are sorted using its threads.
+    PointSorter(const SortKeyList& keys, ThreadPool *pool = NULL) :
+        m_keys(keys), m_pool(pool)
+    {}
+
+    // The sorted order of the points of a view: element i is the current
+    // position of the point that belongs at position i.
+    std::vector<PointId> order(const PointView& view) const;
+    void sort(PointView& view) const;
+
+    // The value of a key for each point of a view, as an integer that
+    // orders the same way (descending keys are inverted).  Comparing
+    // these lets points from different views be merged in sorted order.
+    static std::vector<uint64_t> keyValues(const PointView& view,
+        const SortKey& key);
+    // Position of a point along a curve, with 'x' and 'y' scaled to 32
+    // bits within the curve's bounds.
+    static uint64_t mortonCode(uint32_t x, uint32_t y);
+    static uint64_t hilbertCode(uint32_t x, uint32_t y);
+    // Position along a 3D Morton curve, with each coordinate scaled to 21
+    // bits.
+    static uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z);
+
+private:
+    SortKeyList m_keys;
+    ThreadPool *m_pool;
+};
+
+} // namespace pdal
@@ -34,23 +34,44 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
+#include "pdal/BlockAllocator.hpp"
 #include "pdal/Dimension.hpp"
+#include "pdal/MemoryTracker.hpp"
 #include "pdal/PointLayout.hpp"
 #include "pdal/Metadata.hpp"
 
 namespace pdal
 {
 
+class PointView;
+
+// The views that exist for a table.  Views add and remove themselves so
+// that the table can find the points that are still in use when it
+// compacts its storage.  The list is shared with the views so that a view
+// can outlive its table.
+struct ViewList
+{
+    std::mutex m_mutex;
+    std::set<PointView *> m_views;
+};
+typedef std::shared_ptr<ViewList> ViewListPtr;
+
 class PDAL_DLL BasePointTable
 {
     friend class PointView;
+    template<typename T> friend class DimAccessor;
 
 public:
-    BasePointTable() : m_metadata(new Metadata())
+    BasePointTable() : m_metadata(new Metadata()),
+        m_memory(new MemoryTracker()), m_views(new ViewList()),
+        m_compactFraction(0), m_rowBlocks(NULL), m_rowBlockPtCnt(0)
         {}
     virtual ~BasePointTable()
         {}
@@ -59,6 +80,42 @@ public:
     // Layout operations.
     virtual PointLayoutPtr layout() const = 0;
 
+    // Prepare to have 'count' more points added.  This is only a hint.
+    virtual void reserve(point_count_t /*count*/)
+        {}
+    // Number of bytes of point storage that the table has allocated.
+    virtual std::size_t allocatedBytes() const
+        { return 0; }
+    // Tracker for the memory used by the table and by the views, indexes
+    // and stage buffers built on it.
+    MemoryTrackerPtr memory() const
+        { return m_memory; }
+
+    // Number of points added to the table, including any that no view
+    // refers to any longer.
+    virtual point_count_t numPoints() const
+        { return 0; }
+    // Move the points that views of the table refer to into densely packed
+    // storage, update the views and free the storage that's left over.
+    // Views keep their order, but the table IDs of points change.  Returns
+    // false if the table doesn't support compaction or nothing was freed.
+    virtual bool compact()
+        { return false; }
+    // Compact the table after a stage runs if its views refer to fewer
+    // than 'fraction' of its points.  Zero, the default, turns this off.
+    void setAutoCompact(double fraction)
+        { m_compactFraction = fraction; }
+    double autoCompact() const
+        { return m_compactFraction; }
+    // Compact if automatic compaction is on and few enough points are in
+    // use.  Returns true if the table was compacted.
+    bool compactIfSparse();
+    // An empty table that stores points the way this one does, with a copy
+    // of this table's finalized layout and sharing its metadata and memory
+    // tracker, for an input branch that executes at the same time as
+    // others.
+    virtual std::unique_ptr<BasePointTable> makeBranch();
+
     // Metadata operations.
     MetadataNode metadata()
         { return m_metadata->getNode(); }
@@ -73,9 +130,48 @@ private:
         const void *value) = 0;
     virtual void getField(const Dimension::Detail *d, PointId idx,
         void *value) = 0;
+    // Number of points, starting with point idx, that are stored one after
+    // another as packed records, whether or not they have been added yet.
+    // Zero if the table doesn't store packed records.
+    virtual point_count_t contiguousPoints(PointId /*idx*/) const
+        { return 0; }
 
 protected:
     MetadataPtr m_metadata;
+    MemoryTrackerPtr m_memory;
+    ViewListPtr m_views;
+    double m_compactFraction;
+    // Tables that store packed point records in blocks of a fixed number
+    // of points publish the blocks here, so that a point's record can be
+    // found without a virtual call.  NULL for other tables.
+    const std::vector<char *> *m_rowBlocks;
+    point_count_t m_rowBlockPtCnt;
+
+    // The record of point 'id' in published blocks, or NULL if the
+    // table doesn't publish them or the point isn't in one.
+    char *rowPoint(PointId id, std::size_t pointSize) const
+    {
+        if (!m_rowBlocks)
+            return NULL;
+        std::size_t block = id / m_rowBlockPtCnt;
+        if (block >= m_rowBlocks->size())
+            return NULL;
+        return (*m_rowBlocks)[block] + (id % m_rowBlockPtCnt) * pointSize;
+    }
+
+    // Use the metadata and memory tracker of another table instead of
+    // our own.
+    void share(const BasePointTable& other)
+    {
+        m_metadata = other.m_metadata;
+        m_memory = other.m_memory;
+    }
+
+    // The sorted, distinct IDs of the points that views refer to.
+    std::vector<PointId> liveIds() const;
+    // Point views at the new positions of their points, where the point at
+    // 'live[i]' has moved to 'i'.
+    void remapViews(const std::vector<PointId>& live);
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -85,21 +181,54 @@ typedef BasePointTable const & ConstPointTableRef;
 // to be used to process multiple point sets simultaneously.
 class PDAL_DLL PointTable : public BasePointTable
 {
-private:
+protected:
     // Point storage.
     std::vector<char *> m_blocks;
     point_count_t m_numPts;
     std::unique_ptr<PointLayout> m_layout;
 
 public:
-    PointTable() : m_numPts(0), m_layout(new PointLayout())
-        {}
+    // The default number of points in each memory block.
+    static const point_count_t DefaultBlockPtCnt = 65536;
+
+    PointTable() : m_numPts(0), m_layout(new PointLayout()),
+        m_allocator(BlockAllocator::heap()),
+        m_blockPtCnt(DefaultBlockPtCnt), m_zeroFill(true)
+    {
+        m_rowBlocks = &m_blocks;
+        m_rowBlockPtCnt = m_blockPtCnt;
+    }
+    // Get point storage from 'allocator' in blocks of 'blockPtCnt' points.
+    // If 'zeroFill' is false, new points aren't cleared and dimensions
+    // that no stage sets have undefined values, so only turn it off when
+    // every stage writes all the dimensions it registers.
+    PointTable(BlockAllocator& allocator,
+            point_count_t blockPtCnt = DefaultBlockPtCnt,
+            bool zeroFill = true) :
+        m_numPts(0), m_layout(new PointLayout()), m_allocator(allocator),
+        m_blockPtCnt(blockPtCnt ? blockPtCnt : DefaultBlockPtCnt),
+        m_zeroFill(zeroFill)
+    {
+        m_rowBlocks = &m_blocks;
+        m_rowBlockPtCnt = m_blockPtCnt;
+    }
     virtual ~PointTable();
 
     virtual PointLayoutPtr layout() const
         { return m_layout.get(); }
+    virtual void reserve(point_count_t count)
+    {
+        m_blocks.reserve((m_numPts + count + m_blockPtCnt - 1) /
+            m_blockPtCnt);
+    }
+    virtual std::size_t allocatedBytes() const
+        { return m_blocks.size() * m_blockPtCnt * m_layout->pointSize(); }
+    virtual point_count_t numPoints() const
+        { return m_numPts; }
+    virtual bool compact();
+    virtual std::unique_ptr<BasePointTable> makeBranch();
 
-private:
+protected:
     // Point data operations.
     virtual PointId addPoint();
     virtual char *getPoint(PointId idx);
@@ -107,9 +236,13 @@ private:
         const void *value);
     virtual void getField(const Dimension::Detail *d, PointId idx,
         void *value);
+    virtual point_count_t contiguousPoints(PointId idx) const
+        { return m_blockPtCnt - (idx % m_blockPtCnt); }
 
+    BlockAllocator& m_allocator;
     // The number of points in each memory block.
-    static const point_count_t m_blockPtCnt = 65536;
+    const point_count_t m_blockPtCnt;
+    bool m_zeroFill;
 
     char *getDimension(const Dimension::Detail *d, PointId idx)
         { return getPoint(idx) + d->offset(); }
@@ -118,5 +251,151 @@ private:
         { return m_layout->pointSize() * numPts; }
 };
 
+
+// A point table that holds no more than a fixed number of points.  It is
+// used to run a pipeline in streaming mode, where the table is reset and
+// its storage reused for each chunk of points, so that memory use doesn't
+// depend on the size of the input.
+class PDAL_DLL StreamPointTable : public PointTable
+{
+public:
+    StreamPointTable(point_count_t capacity) :
+        PointTable(BlockAllocator::heap(),
+            (std::min)(capacity, DefaultBlockPtCnt)),
+        m_capacity(capacity)
+        {}
+
+    point_count_t capacity() const
+        { return m_capacity; }
+    // Change the number of points in a chunk.  Only for use before any
+    // points have been added, once the layout is known, say.
+    void setCapacity(point_count_t capacity)
+        { m_capacity = capacity; }
+
+    // Discard all points, keeping the allocated storage for reuse.
+    void reset();
+    // Storage is reused for each chunk rather than compacted.
+    virtual bool compact()
+        { return false; }
+
+private:
+    point_count_t m_capacity;
+
+    virtual PointId addPoint();
+};
+
+
+// A point table whose blocks are mapped from a sparse scratch file rather
+// than allocated on the heap, so that a point set can exceed the size of
+// physical memory and the OS can page blocks in and out as needed.  The
+// scratch file is created in the provided directory (the system temporary
+// directory by default) and is unlinked immediately, so it disappears when
+// the table is destroyed or the process exits.  Since the OS can page them
+// out, mapped blocks aren't charged to the table's memory tracker.
+class PDAL_DLL MappedPointTable : public PointTable
+{
+public:
+    // How stages are expected to access the points in the table.
+    enum class Access
+    {
+        Normal,
+        Sequential,
+        Random
+    };
+
+    MappedPointTable(const std::string& tempDir = "");
+    virtual ~MappedPointTable();
+
+    // Give the OS a hint about how the points will be accessed.  Applies
+    // to existing and future blocks.
+    void setAccess(Access access);
+    // The OS pages mapped blocks out as needed, so they aren't compacted.
+    virtual bool compact()
+        { return false; }
+    virtual std::unique_ptr<BasePointTable> makeBranch();
+
+private:
+    std::string m_tempDir;
+    int m_fd;
+    Access m_access;
+
+    virtual PointId addPoint();
+    void advise(char *buf, std::size_t size);
+};
+
+// Point storage for one input branch of a stage whose branches execute at
+// the same time, for main tables that don't make their own (see
+// makeBranch()).  The table starts with a copy of the main table's
+// finalized layout and shares its metadata, so points can be copied from
+// it to the main table once the branch is done.
+class PDAL_DLL BranchPointTable : public PointTable
+{
+public:
+    BranchPointTable(BasePointTable& main)
+    {
+        *m_layout = *main.layout();
+        share(main);
+    }
+};
+
+// A point table that stores each dimension in its own array rather than
+// interleaving all the dimensions of a point.  Stages that scan only a few
+// dimensions (X/Y/Z, for instance) touch only the memory for those
+// dimensions.  Points are allocated in blocks, as with PointTable, but
+// within a block the values of each dimension are contiguous.  Row access
+// through getPoint() isn't supported.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+protected:
+    // Point storage.
+    std::vector<char *> m_blocks;
+    point_count_t m_numPts;
+    std::unique_ptr<PointLayout> m_layout;
+
+public:
+    ColumnPointTable() : m_numPts(0), m_layout(new PointLayout()),
+        m_allocator(BlockAllocator::heap())
+        {}
+    ColumnPointTable(BlockAllocator& allocator) : m_numPts(0),
+        m_layout(new PointLayout()), m_allocator(allocator)
+        {}
+    virtual ~ColumnPointTable();
+
+    virtual PointLayoutPtr layout() const
+        { return m_layout.get(); }
+    virtual void reserve(point_count_t count)
+    {
+        m_blocks.reserve((m_numPts + count + m_blockPtCnt - 1) /
+            m_blockPtCnt);
+    }
+    virtual std::size_t allocatedBytes() const
+        { return m_blocks.size() * m_blockPtCnt * m_layout->pointSize(); }
+    virtual point_count_t numPoints() const
+        { return m_numPts; }
+    virtual bool compact();
+    virtual std::unique_ptr<BasePointTable> makeBranch();
+
+protected:
+    // Point data operations.
+    virtual PointId addPoint();
+    virtual char *getPoint(PointId idx);
+    virtual void setField(const Dimension::Detail *d, PointId idx,
+        const void *value);
+    virtual void getField(const Dimension::Detail *d, PointId idx,
+        void *value);
+
+    BlockAllocator& m_allocator;
+    // The number of points in each memory block.
+    static const point_count_t m_blockPtCnt = 65536;
+
+    // A dimension's column in a block starts at the dimension's offset
+    // scaled by the number of points in the block.
+    char *getDimension(const Dimension::Detail *d, PointId idx)
+    {
+        return m_blocks[idx / m_blockPtCnt] + d->offset() * m_blockPtCnt +
+            (idx % m_blockPtCnt) * d->size();
+    }
+};
+
 } //namespace
 
@@ -36,14 +36,17 @@
 
 #include <pdal/util/Bounds.hpp>
 #include <pdal/pdal_internal.hpp>
+#include <pdal/PointIdList.hpp>
 #include <pdal/PointLayout.hpp>
+#include <pdal/PointSelection.hpp>
 #include <pdal/PointTable.hpp>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <vector>
-#include <deque>
 
 #ifdef PDAL_COMPILER_MSVC
 #  pragma warning(disable: 4244)  // conversion from 'type1' to 'type2', possible loss of data
@@ -57,6 +60,7 @@ namespace plang
 }
 
 struct PointViewLess;
+template<typename T> class DimAccessor;
 class PointView;
 class PointViewIter;
 
@@ -68,16 +72,28 @@ class PDAL_DLL PointView
     friend class plang::BufferedInvocation;
     friend class PointRef;
     friend struct PointViewLess;
+    friend class BasePointTable;
+    template<typename T> friend class DimAccessor;
 public:
     PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-        m_size(0), m_id(0)
+        m_size(0), m_id(0), m_views(pointTable.m_views)
     {
-        static int lastId = 0;
+        // Views may be created by stages running on several threads.
+        static std::atomic<int> lastId(0);
         m_id = ++lastId;
+        m_index.track(pointTable.memory());
+        addToTable();
     }
+    PointView(const PointView& other) : m_pointTable(other.m_pointTable),
+        m_index(other.m_index), m_size(other.m_size), m_id(other.m_id),
+        m_temps(other.m_temps), m_views(other.m_views)
+        { addToTable(); }
 
     virtual ~PointView()
-    {}
+    {
+        std::lock_guard<std::mutex> lock(m_views->m_mutex);
+        m_views->m_views.erase(this);
+    }
 
     PointViewIter begin();
     PointViewIter end();
@@ -91,14 +107,20 @@ public:
     bool empty() const
         { return m_size == 0; }
 
+    /// Prepare for \a count more points to be added to the view and its
+    /// point table.  This is only a hint.
+    void reserve(point_count_t count)
+    {
+        m_index.reserve(m_index.size() + count);
+        m_pointTable.reserve(count);
+    }
+
     inline void appendPoint(const PointView& buffer, PointId id);
     void append(const PointView& buf)
     {
         // We use size() instead of the index end because temp points
         // might have been placed at the end of the buffer.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
+        m_index.insert(size(), buf.m_index, buf.size());
         m_size += buf.size();
         clearTemps();
     }
@@ -108,6 +130,21 @@ public:
     PointViewPtr makeNew() const
         { return PointViewPtr(new PointView(m_pointTable)); }
 
+    /// Put the points in a new order, where \a order[i] is the current
+    /// position of the point that is to be at position \a i.
+    void reorder(const std::vector<PointId>& order);
+
+    /// Return a new point view with the points of this one that are
+    /// selected, in order.
+    PointViewPtr makeSubset(const PointSelection& sel) const
+    {
+        PointViewPtr view = makeNew();
+        for (PointId idx = sel.first(); idx < sel.size(); idx = sel.next(idx))
+            view->m_index.push_back(m_index[idx]);
+        view->m_size = sel.count();
+        return view;
+    }
+
     template<class T>
     T getFieldAs(Dimension::Id::Enum dim, PointId pointIndex) const;
 
@@ -190,6 +227,8 @@ public:
     static void calculateBounds(const PointViewSet&, BOX3D& box);
 
     void dump(std::ostream& ostr) const;
+    PointLayoutPtr layout() const
+        { return m_pointTable.layout(); }
     bool hasDim(Dimension::Id::Enum id) const
         { return m_pointTable.layout()->hasDim(id); }
     std::string dimName(Dimension::Id::Enum id) const
@@ -200,8 +239,16 @@ public:
         { return m_pointTable.layout()->pointSize(); }
     std::size_t dimSize(Dimension::Id::Enum id) const
         { return m_pointTable.layout()->dimSize(id); }
+    std::size_t dimOffset(Dimension::Id::Enum id) const
+        { return m_pointTable.layout()->dimOffset(id); }
+    Dimension::Type::Enum dimType(Dimension::Id::Enum id) const
+        { return m_pointTable.layout()->dimType(id); }
     DimTypeList dimTypes() const
         { return m_pointTable.layout()->dimTypes(); }
+    /// Tracker for the memory used by the view's point table and the
+    /// structures built on it.
+    MemoryTrackerPtr memory() const
+        { return m_pointTable.memory(); }
 
     /// Fill a buffer with point data specified by the dimension list.
     /// \param[in] dims  List of dimensions/types to retrieve.
@@ -236,6 +283,27 @@ public:
     char *getPoint(PointId id)
         { return m_pointTable.getPoint(m_index[id]); }
 
+    /// Get the address of the data for a run of points that are stored
+    /// one after another in the point table.  Each point is a record of
+    /// PointLayout::pointSize() bytes with dimensions at
+    /// PointLayout::dimOffset().
+    /// \param[in] idx    Index of the first point in the run.
+    /// \param[in] count  Maximum number of points in the run.
+    /// \param[out] buf   Set to the address of the data of point \a idx.
+    /// \return  Number of points in the run, which may be less than
+    ///    \a count.  Zero if the point table doesn't store packed records.
+    point_count_t getSpan(PointId idx, point_count_t count, char *& buf);
+
+    /// Add a run of points to the end of the view and get the address of
+    /// their data so that it can be written directly, as with getSpan().
+    /// Points are zeroed when added.
+    /// \param[in] count  Maximum number of points to add.
+    /// \param[out] buf   Set to the address of the data of the first point.
+    /// \return  Number of points added, which may be less than \a count.
+    ///    Zero if the point table doesn't store packed records, in which
+    ///    case points must be added with setField().
+    point_count_t appendSpan(point_count_t count, char *& buf);
+
     // The standard idiom is swapping with a stack-created empty queue, but
     // that invokes the ctor and probably allocates.  We've probably only got
     // one or two things in our queue, so just pop until we're empty.
@@ -247,14 +315,21 @@ public:
 
 protected:
     PointTableRef m_pointTable;
-    std::deque<PointId> m_index;
+    PointIdList m_index;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
     int m_id;
     std::queue<PointId> m_temps;
+    // The views of our table, which the table walks when it compacts.
+    ViewListPtr m_views;
 
 private:
+    void addToTable()
+    {
+        std::lock_guard<std::mutex> lock(m_views->m_mutex);
+        m_views->m_views.insert(this);
+    }
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id::Enum dim, PointId idx, T_IN in);
 
@@ -264,6 +339,10 @@ private:
     T getFieldInternal(Dimension::Id::Enum dim, PointId pointIndex) const;
     inline void getFieldInternal(Dimension::Id::Enum dim, PointId pointIndex,
         void *value) const;
+    inline void getFieldInternal(const Dimension::Detail *dd,
+        PointId pointIndex, void *value) const;
+    inline void setFieldInternal(const Dimension::Detail *dd, PointId idx,
+        const void *value);
     inline PointId getTemp(PointId id);
     void freeTemp(PointId id)
         { m_temps.push(id); }
@@ -499,13 +578,26 @@ void PointView::setField(Dimension::Id::Enum dim, PointId idx, T val)
 inline void PointView::getFieldInternal(Dimension::Id::Enum dim,
     PointId id, void *buf) const
 {
-    m_pointTable.getField(m_pointTable.layout()->dimDetail(dim),
-        m_index[id], buf);
+    getFieldInternal(m_pointTable.layout()->dimDetail(dim), id, buf);
+}
+
+
+inline void PointView::getFieldInternal(const Dimension::Detail *dd,
+    PointId id, void *buf) const
+{
+    m_pointTable.getField(dd, m_index[id], buf);
 }
 
 
 inline void PointView::setFieldInternal(Dimension::Id::Enum dim,
     PointId id, const void *value)
+{
+    setFieldInternal(m_pointTable.layout()->dimDetail(dim), id, value);
+}
+
+
+inline void PointView::setFieldInternal(const Dimension::Detail *dd,
+    PointId id, const void *value)
 {
     PointId rawId = 0;
     if (id == size())
@@ -525,8 +617,7 @@ inline void PointView::setFieldInternal(Dimension::Id::Enum dim,
     {
         rawId = m_index[id];
     }
-    m_pointTable.setField(m_pointTable.layout()->dimDetail(dim),
-        rawId, value);
+    m_pointTable.setField(dd, rawId, value);
 }
 
 
@@ -548,7 +639,7 @@ inline PointId PointView::getTemp(PointId id)
     {
         newid = m_temps.front();
         m_temps.pop();
-        m_index[newid] = m_index[id];
+        m_index.set(newid, m_index[id]);
     }
     else
     {
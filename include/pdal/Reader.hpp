@@ -53,6 +53,11 @@ public:
     void setReadCb(PointReadFunc cb)
         { m_cb = cb; }
 
+    // Number of points the reader will provide, if known once the stage
+    // is ready.  Zero if it isn't known.
+    virtual point_count_t numPoints() const
+        { return 0; }
+
 protected:
     std::string m_filename;
     point_count_t m_count;
@@ -63,11 +68,23 @@ private:
     {
         PointViewSet viewSet;
 
+        // Size the table and view for the points we know are coming.
+        point_count_t count = (std::min)(numPoints(), m_count);
+        if (count)
+            view->reserve(count);
         view->clearTemps();
         read(view, m_count);
         viewSet.insert(view);
         return viewSet;
     }
+    virtual point_count_t readChunk(PointViewPtr view, point_count_t numRead,
+        point_count_t count)
+    {
+        if (numRead >= m_count)
+            return 0;
+        view->clearTemps();
+        return read(view, (std::min)(count, m_count - numRead));
+    }
     virtual void readerProcessOptions(const Options& options);
     virtual point_count_t read(PointViewPtr /*view*/, point_count_t /*num*/)
         { return 0; }
@@ -38,6 +38,7 @@
 #include <pdal/plugin.hpp>
 
 #include <pdal/Dimension.hpp>
+#include <pdal/DimPredicate.hpp>
 #include <pdal/Log.hpp>
 #include <pdal/Metadata.hpp>
 #include <pdal/Options.hpp>
@@ -45,10 +46,13 @@
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/StageProfile.hpp>
 #include <pdal/UserCallback.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <set>
+
 namespace pdal
 {
 
@@ -82,6 +86,7 @@ public:
     }
     void prepare(PointTableRef table);
     PointViewSet execute(PointTableRef table);
+    void execute(StreamPointTable& table);
 
     void setSpatialReference(SpatialReference const&);
     const SpatialReference& getSpatialReference() const;
@@ -123,6 +128,57 @@ public:
     virtual boost::property_tree::ptree toPTree(PointTableRef table) const
         { return boost::property_tree::ptree(); }
 
+    /// Whether this stage can process its points a chunk at a time instead
+    /// of needing all of them at once.  Options have been processed
+    /// (the stage has been prepared) when this is called.
+    virtual bool streamable() const
+        { return false; }
+
+    /// Whether run() may be called for different views at the same time.
+    /// A stage that returns true must not change its own state in run()
+    /// and must not add points to the point table.  It may read and set
+    /// fields of the points in the view it is given and create new views
+    /// of those points.
+    virtual bool threadSafe() const
+        { return false; }
+
+    /// Whether this stage can execute at the same time as the stages in
+    /// other input branches of a pipeline.  Stages that depend on
+    /// process-wide state, such as an embedded interpreter, return false.
+    virtual bool branchSafe() const
+        { return true; }
+
+    /// Names of the dimensions this stage reads from the points it is
+    /// given.  Called by prepare() before any options have been processed,
+    /// so implementations must work from getOptions().  Return false (the
+    /// default) if the stage may read any dimension.
+    virtual bool usedDims(StringList& /*dims*/) const
+        { return false; }
+
+    /// Conditions that points must meet to pass through this stage.  A
+    /// stage that does nothing but drop the points that fail any of them
+    /// returns true, which lets a reader at the start of the pipeline check
+    /// them instead.  Called by prepare() before options are processed.
+    virtual bool predicates(DimPredicateList& /*preds*/) const
+        { return false; }
+
+    /// Whether this stage can drop the points that fail a predicate of a
+    /// later stage before they are stored.
+    virtual bool acceptsPredicate(const DimPredicate& /*pred*/) const
+        { return false; }
+
+    /// Whether this stage does nothing but drop points from each view it's
+    /// given, keeping the order of the rest, so that it can be run with
+    /// select() instead of run().  A chain of such stages is run as one
+    /// pass over each view that makes a single output view.  Options have
+    /// been processed when this is called.
+    virtual bool selects() const
+        { return false; }
+    /// Whether a selecting stage drops the views it's given that have no
+    /// points, rather than passing them on empty.
+    virtual bool dropsEmptyViews() const
+        { return false; }
+
     virtual StageSequentialIterator* createSequentialIterator() const
         { return NULL; }
     inline MetadataNode getMetadata() const
@@ -140,10 +196,42 @@ protected:
 
     void setSpatialReference(MetadataNode& m, SpatialReference const&);
 
+    /// Whether a stage downstream of this one reads a dimension.  Readers
+    /// may skip registering and decoding dimensions for which this is
+    /// false.  Only valid once prepare() has been called.
+    bool dimNeeded(const std::string& name) const;
+    bool dimNeeded(Dimension::Id::Enum id) const
+        { return dimNeeded(Dimension::name(id)); }
+
+    /// Predicates of later stages that this stage has accepted.  Points
+    /// that fail any of them must not be added to a view.
+    const DimPredicateList& pushedPredicates() const
+        { return m_pushedPreds; }
+
+    /// Whether this stage's predicates are checked by a reader, so that
+    /// every point it is given already meets them.
+    bool predicatesPushed() const
+        { return m_predsPushed; }
+
+    /// Run selecting stages over \a view in order and return the view of
+    /// the points none of them dropped, which is \a view itself if all
+    /// points are kept.  Returns a null pointer if a stage that drops empty
+    /// views is given no points.
+    static PointViewPtr runSelection(const std::vector<Stage *>& stages,
+        PointViewPtr view);
+
 private:
     bool m_debug;
     uint32_t m_verbose;
     std::vector<Stage *> m_inputs;
+    bool m_allDimsNeeded;
+    std::set<std::string> m_dimsNeeded;
+    DimPredicateList m_pushedPreds;
+    bool m_predsPushed;
+    std::unique_ptr<StageProfile> m_profile;
+    // The selecting stages run as one pass when this stage executes:
+    // the ones upstream, source first, and then this one (see selects()).
+    std::vector<Stage *> m_selectChain;
     LogPtr m_log;
     SpatialReference m_spatialReference;
 
@@ -157,8 +245,14 @@ private:
         {}
     virtual void writerProcessOptions(const Options& /*options*/)
         {}
+    void l_prepare(PointTableRef table);
+    void pushDims(bool all, const std::set<std::string>& dims);
+    void pushPredicates(std::vector<Stage *> chain,
+        const std::set<Stage *>& shared);
     void l_initialize(PointTableRef table);
     void l_done(PointTableRef table);
+    PointViewSet executeInputs(PointTableRef table);
+    bool independentInputs() const;
     virtual QuickInfo inspect()
         { return QuickInfo(); }
     virtual void initialize()
@@ -176,6 +270,15 @@ private:
         std::cerr << "Can't run stage = " << getName() << "!\n";
         return PointViewSet();
     }
+    /// Clear the entries of \a sel for the points of \a view that the stage
+    /// drops (see selects()).  Only points still selected need be checked.
+    /// Stages that use the position of a point in their input must count
+    /// selected points rather than use positions in \a view.
+    virtual void select(PointView& /*view*/, PointSelection& /*sel*/)
+        {}
+    virtual point_count_t readChunk(PointViewPtr /*view*/,
+        point_count_t /*numRead*/, point_count_t /*count*/)
+        { return 0; }
 };
 
 PDAL_DLL std::ostream& operator<<(std::ostream& ostr, const Stage&);
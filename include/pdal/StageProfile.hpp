@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Metadata.hpp>
+
+#include <cstddef>
+#include <mutex>
+
+namespace pdal
+{
+
+// Timings, point counts and table memory recorded for one execution of a
+// stage when profiling is turned on (see GlobalEnvironment::setProfiling()).
+// The results are added to the stage's metadata under 'profile'.
+class PDAL_DLL StageProfile
+{
+public:
+    enum Phase
+    {
+        Prepare,
+        Ready,
+        Run,
+        Done,
+        NumPhases
+    };
+
+    // Records the wall and CPU time spent between its construction and
+    // destruction against a phase.  Does nothing if the profile is null,
+    // so timers can stay in place when profiling is off.
+    class Timer
+    {
+    public:
+        Timer(StageProfile *profile, Phase phase) : m_profile(profile),
+            m_phase(phase), m_wall(0), m_cpu(0)
+        {
+            if (m_profile)
+            {
+                m_wall = wallTime();
+                m_cpu = cpuTime();
+            }
+        }
+        ~Timer()
+        {
+            if (m_profile)
+                m_profile->add(m_phase, wallTime() - m_wall,
+                    cpuTime() - m_cpu);
+        }
+
+    private:
+        StageProfile *m_profile;
+        Phase m_phase;
+        double m_wall;
+        double m_cpu;
+
+        Timer(const Timer&); // not implemented
+        Timer& operator=(const Timer&); // not implemented
+    };
+
+    StageProfile();
+
+    // Add time spent in a phase.  Views may be run on several threads at
+    // once, so this and the other update functions are thread-safe.
+    void add(Phase phase, double wall, double cpu);
+    void addPoints(point_count_t in, point_count_t out);
+    // Note the number of bytes used by the point table.
+    void sampleTable(std::size_t bytes);
+    // Note the peak memory use of the pipeline (see MemoryTracker).
+    void sampleMemory(std::size_t peak);
+    // Add the results as a 'profile' child of 'parent'.
+    void write(MetadataNode parent) const;
+
+    // Seconds since an arbitrary point.
+    static double wallTime();
+    // CPU seconds used by the calling thread.
+    static double cpuTime();
+
+private:
+    mutable std::mutex m_mutex;
+    double m_wall[NumPhases];
+    double m_cpu[NumPhases];
+    point_count_t m_pointsIn;
+    point_count_t m_pointsOut;
+    std::size_t m_peakTableBytes;
+    std::size_t m_peakMemoryBytes;
+};
+
+} // namespace pdal
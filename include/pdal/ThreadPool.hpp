@@ -0,0 +1,113 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pdal
+{
+
+// A fixed-size pool of worker threads.  Each worker has its own task queue.
+// Tasks are spread across the queues as they're added; a worker that runs
+// out of its own tasks steals from the other queues.
+class PDAL_DLL ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    ThreadPool(size_t numThreads);
+    ~ThreadPool();
+
+    size_t numThreads() const
+        { return m_threads.size(); }
+
+    void add(Task task);
+
+    // Run one queued task on the calling thread, if there is one.  Threads
+    // waiting for a result should call this rather than block so that they
+    // don't sit idle (or deadlock) while work is pending.
+    bool runOne();
+
+    // Wait for a result, running queued tasks in the meantime.  Once no
+    // task is queued, the one producing the result is running on some
+    // thread, so just block until it's done.
+    template<typename T>
+    void wait(std::future<T>& future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready)
+        {
+            if (!runOne())
+            {
+                future.wait();
+                break;
+            }
+        }
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex m_mutex;
+        std::deque<Task> m_tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::atomic<size_t> m_queued;
+    std::atomic<size_t> m_next;
+    bool m_stop;
+
+    void work(size_t id);
+    bool take(size_t id, Task& task);
+
+    ThreadPool(const ThreadPool&); // not implemented
+    ThreadPool& operator=(const ThreadPool&); // not implemented
+};
+
+} // namespace pdal
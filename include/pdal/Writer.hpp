@@ -72,6 +72,14 @@ protected:
 
     virtual void setAutoXForm(const PointViewPtr view);
 
+    // Whether any scale or offset is to be computed from the data.
+    bool hasAutoXForm() const
+    {
+        return m_xXform.m_autoScale || m_xXform.m_autoOffset ||
+            m_yXform.m_autoScale || m_yXform.m_autoOffset ||
+            m_zXform.m_autoScale || m_zXform.m_autoOffset;
+    }
+
 private:
     virtual PointViewSet run(PointViewPtr view)
     {
@@ -117,6 +117,28 @@ public:
     static void fileTimes(const std::string& filename, struct tm *createTime,
         struct tm *modTime);
 
+    // A read-only mapping of a whole file.  'm_addr' is NULL if the file
+    // couldn't be mapped, and 'm_error' says why.
+    struct MapContext
+    {
+        MapContext() : m_addr(NULL), m_size(0), m_fd(-1)
+        {}
+
+        const char *m_addr;
+        uint64_t m_size;
+        int m_fd;
+        std::string m_error;
+    };
+
+    // Map a regular file for reading, with the system told that it will be
+    // read sequentially.  Pipes, devices and empty files aren't mapped.
+    static MapContext mapFile(const std::string& filename);
+    static void unmapFile(MapContext& ctx);
+    // Ask the system to start reading part of a mapped file that will soon
+    // be needed.
+    static void prefetch(const MapContext& ctx, uint64_t offset,
+        uint64_t size);
+
 private:
     static std::string addTrailingSlash(std::string path);
 
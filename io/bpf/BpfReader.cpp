@@ -150,10 +150,15 @@ void BpfReader::addDimensions(PointLayoutPtr layout)
         Dimension::Type::Enum type = Dimension::Type::Float;
 
         BpfDimension& dim = m_dims[i];
+        dim.m_id = Dimension::Id::Unknown;
         if (dim.m_label == "X" ||
             dim.m_label == "Y" ||
             dim.m_label == "Z")
             type = Dimension::Type::Double;
+        // Dimensions other than X, Y and Z are skipped if nothing
+        // downstream reads them.
+        else if (!dimNeeded(dim.m_label))
+            continue;
         dim.m_id = layout->registerOrAssignDim(dim.m_label, type);
     }
 }
@@ -241,6 +246,15 @@ void BpfReader::done(PointTableRef)
 }
 
 
+// Only the dimensions that every BPF file has are known before the header
+// is read.
+bool BpfReader::acceptsPredicate(const DimPredicate& pred) const
+{
+    return pred.m_id == Dimension::Id::X || pred.m_id == Dimension::Id::Y ||
+        pred.m_id == Dimension::Id::Z;
+}
+
+
 point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
 {
     switch (m_header.m_pointFormat)
@@ -288,43 +302,144 @@ point_count_t BpfReader::readPointMajor(PointViewPtr data, point_count_t count)
     PointId idx = m_index;
     point_count_t numRead = 0;
     seekPointMajor(idx);
+
+    // If the dimensions have the types we registered, points can be
+    // written straight into table memory when the table allows it.
+    std::vector<size_t> offsets;
+    bool direct = true;
+    int xyzCount = 0;
+    for (size_t d = 0; direct && d < m_dims.size(); ++d)
+    {
+        Dimension::Id::Enum id = m_dims[d].m_id;
+        Dimension::Type::Enum type = Dimension::Type::Float;
+        if (id == Dimension::Id::Unknown)
+        {
+            offsets.push_back(0);
+            continue;
+        }
+        if (id == Dimension::Id::X || id == Dimension::Id::Y ||
+            id == Dimension::Id::Z)
+        {
+            type = Dimension::Type::Double;
+            xyzCount++;
+        }
+        direct = (data->dimType(id) == type);
+        offsets.push_back(data->dimOffset(id));
+    }
+    direct = direct && (xyzCount == 3) && pushedPredicates().empty();
+
+    while (direct && numRead < count && idx < numPoints())
+    {
+        char *pos;
+        point_count_t num = data->appendSpan(
+            (std::min)(count - numRead, numPoints() - idx), pos);
+        if (num == 0)
+            break;
+        readPointMajorSpan(pos, num, offsets, data->pointSize());
+        if (m_cb)
+            for (PointId i = 0; i < num; ++i)
+                m_cb(*data, nextId + i);
+        idx += num;
+        numRead += num;
+        nextId += num;
+    }
+
+    std::vector<double> vals(m_dims.size());
     while (numRead < count && idx < numPoints())
     {
+        double x(0), y(0), z(0);
         for (size_t d = 0; d < m_dims.size(); ++d)
         {
             float f;
 
             m_stream >> f;
-            data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
+            Dimension::Id::Enum id = m_dims[d].m_id;
+            vals[d] = f + m_dims[d].m_offset;
+            if (id == Dimension::Id::X)
+                x = vals[d];
+            else if (id == Dimension::Id::Y)
+                y = vals[d];
+            else if (id == Dimension::Id::Z)
+                z = vals[d];
         }
+        idx++;
+        numRead++;
 
         // Transformation only applies to X, Y and Z
-        double x = data->getFieldAs<double>(Dimension::Id::X, nextId);
-        double y = data->getFieldAs<double>(Dimension::Id::Y, nextId);
-        double z = data->getFieldAs<double>(Dimension::Id::Z, nextId);
         m_header.m_xform.apply(x, y, z);
+        if (!keepPoint(x, y, z))
+            continue;
+
+        for (size_t d = 0; d < m_dims.size(); ++d)
+            data->setField(m_dims[d].m_id, nextId, vals[d]);
         data->setField(Dimension::Id::X, nextId, x);
         data->setField(Dimension::Id::Y, nextId, y);
         data->setField(Dimension::Id::Z, nextId, z);
 
         if (m_cb)
             m_cb(*data, nextId);
-
-        idx++;
-        numRead++;
         nextId++;
     }
     m_index = idx;
     return numRead;
 }
 
+void BpfReader::readPointMajorSpan(char *pos, point_count_t num,
+    const std::vector<size_t>& offsets, size_t pointSize)
+{
+    for (point_count_t i = 0; i < num; ++i)
+    {
+        double x(0), y(0), z(0);
+        for (size_t d = 0; d < m_dims.size(); ++d)
+        {
+            float f;
+
+            m_stream >> f;
+            double v = f + m_dims[d].m_offset;
+            Dimension::Id::Enum id = m_dims[d].m_id;
+            if (id == Dimension::Id::X)
+                x = v;
+            else if (id == Dimension::Id::Y)
+                y = v;
+            else if (id == Dimension::Id::Z)
+                z = v;
+            else if (id != Dimension::Id::Unknown)
+            {
+                f = (float)v;
+                std::memcpy(pos + offsets[d], &f, sizeof(f));
+            }
+        }
+
+        // Transformation only applies to X, Y and Z
+        m_header.m_xform.apply(x, y, z);
+        for (size_t d = 0; d < m_dims.size(); ++d)
+        {
+            Dimension::Id::Enum id = m_dims[d].m_id;
+            if (id == Dimension::Id::X)
+                std::memcpy(pos + offsets[d], &x, sizeof(x));
+            else if (id == Dimension::Id::Y)
+                std::memcpy(pos + offsets[d], &y, sizeof(y));
+            else if (id == Dimension::Id::Z)
+                std::memcpy(pos + offsets[d], &z, sizeof(z));
+        }
+        pos += pointSize;
+    }
+}
+
+
 point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
 {
+    // With pushed predicates, points are read into a scratch view and only
+    // those that pass are appended to the output.
+    PointViewPtr view = pushedPredicates().empty() ? data : data->makeNew();
+
     PointId idx(0);
-    PointId startId = data->size();
+    PointId startId = view->size();
     point_count_t numRead = 0;
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
+        if (m_dims[d].m_id == Dimension::Id::Unknown)
+            continue;
         idx = m_index;
         PointId nextId = startId;
         numRead = 0;
@@ -334,33 +449,22 @@ point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
             float f;
 
             m_stream >> f;
-            data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
+            view->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
         }
     }
     m_index = idx;
-
-    // Transformation only applies to X, Y and Z
-    for (PointId idx = startId; idx < data->size(); idx++)
-    {
-        double x = data->getFieldAs<double>(Dimension::Id::X, idx);
-        double y = data->getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = data->getFieldAs<double>(Dimension::Id::Z, idx);
-        m_header.m_xform.apply(x, y, z);
-        data->setField(Dimension::Id::X, idx, x);
-        data->setField(Dimension::Id::Y, idx, y);
-        data->setField(Dimension::Id::Z, idx, z);
-
-        if (m_cb)
-            m_cb(*data, idx);
-    }
-
+    finishPoints(*view, startId, *data);
     return numRead;
 }
 
 point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
 {
+    // With pushed predicates, points are read into a scratch view and only
+    // those that pass are appended to the output.
+    PointViewPtr view = pushedPredicates().empty() ? data : data->makeNew();
+
     PointId idx(0);
-    PointId startId = data->size();
+    PointId startId = view->size();
     point_count_t numRead = 0;
 
     // We need a temp buffer for the point data->
@@ -374,6 +478,8 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
 
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
+        if (m_dims[d].m_id == Dimension::Id::Unknown)
+            continue;
         for (size_t b = 0; b < sizeof(float); ++b)
         {
             idx = m_index;
@@ -394,29 +500,57 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
                 if (b == 3)
                 {
                     u.f += m_dims[d].m_offset;
-                    data->setField(m_dims[d].m_id, nextId, u.f);
+                    view->setField(m_dims[d].m_id, nextId, u.f);
                 }
             }
         }
     }
     m_index = idx;
+    finishPoints(*view, startId, *data);
+    return numRead;
+}
 
+
+// Apply the header transformation to the points read into 'view' starting
+// at 'startId'.  If 'view' is a scratch view, the points that pass the
+// pushed predicates are appended to 'data'.
+void BpfReader::finishPoints(PointView& view, PointId startId,
+    PointView& data)
+{
     // Transformation only applies to X, Y and Z
-    for (PointId idx = startId; idx < data->size(); idx++)
+    for (PointId idx = startId; idx < view.size(); idx++)
     {
-        double x = data->getFieldAs<double>(Dimension::Id::X, idx);
-        double y = data->getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = data->getFieldAs<double>(Dimension::Id::Z, idx);
+        double x = view.getFieldAs<double>(Dimension::Id::X, idx);
+        double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
+        double z = view.getFieldAs<double>(Dimension::Id::Z, idx);
         m_header.m_xform.apply(x, y, z);
-        data->setField(Dimension::Id::X, idx, x);
-        data->setField(Dimension::Id::Y, idx, y);
-        data->setField(Dimension::Id::Z, idx, z);
+        view.setField(Dimension::Id::X, idx, x);
+        view.setField(Dimension::Id::Y, idx, y);
+        view.setField(Dimension::Id::Z, idx, z);
 
+        PointId id = idx;
+        if (&view != &data)
+        {
+            if (!keepPoint(x, y, z))
+                continue;
+            id = data.size();
+            data.appendPoint(view, idx);
+        }
         if (m_cb)
-            m_cb(*data, idx);
+            m_cb(data, id);
     }
+}
 
-    return numRead;
+
+// Check the predicates pushed to the reader, which are only on X, Y and Z.
+bool BpfReader::keepPoint(double x, double y, double z) const
+{
+    auto value = [x, y, z](Dimension::Id::Enum id)
+    {
+        return id == Dimension::Id::X ? x :
+            id == Dimension::Id::Y ? y : z;
+    };
+    return passes(pushedPredicates(), value);
 }
 
 
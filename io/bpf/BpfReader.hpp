@@ -60,6 +60,9 @@ public:
 
     virtual point_count_t numPoints() const
         {  return (point_count_t)m_header.m_numPts; }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool acceptsPredicate(const DimPredicate& pred) const;
 private:
     ILeStream m_stream;
     BpfHeader m_header;
@@ -92,8 +95,12 @@ private:
     bool readHeaderExtraData();
     bool readPolarData();
     point_count_t readPointMajor(PointViewPtr data, point_count_t count);
+    void readPointMajorSpan(char *pos, point_count_t num,
+        const std::vector<size_t>& offsets, size_t pointSize);
     point_count_t readDimMajor(PointViewPtr data, point_count_t count);
     point_count_t readByteMajor(PointViewPtr data, point_count_t count);
+    void finishPoints(PointView& view, PointId startId, PointView& data);
+    bool keepPoint(double x, double y, double z) const;
     size_t readBlock(std::vector<char>& outBuf, size_t index);
 
     int inflate(char *inbuf, size_t insize, char *outbuf, size_t outsize);
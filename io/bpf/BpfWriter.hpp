@@ -56,6 +56,11 @@ public:
     std::string getName() const;
 
     Options getDefaultOptions();
+    virtual bool streamable() const
+    {
+        return FlexWriter::streamable() &&
+            m_header.m_pointFormat == BpfFormat::PointMajor;
+    }
 
 private:
     OLeStream m_stream;
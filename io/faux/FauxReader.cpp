@@ -144,7 +144,9 @@ Dimension::IdList FauxReader::getDefaultDimensions()
 
 point_count_t FauxReader::read(PointViewPtr view, point_count_t count)
 {
-    const double numDeltas = (double)count - 1.0;
+    // The ramp spans all the points to be read, which may be more than
+    // are requested by this call.
+    const double numDeltas = (double)m_count - 1.0;
     const double delX = (m_maxX - m_minX) / numDeltas;
     const double delY = (m_maxY - m_minY) / numDeltas;
     const double delZ = (m_maxZ - m_minZ) / numDeltas;
@@ -154,7 +156,8 @@ point_count_t FauxReader::read(PointViewPtr view, point_count_t count)
 
     uint32_t seed = static_cast<uint32_t>(std::time(NULL));
 
-    for (PointId idx = 0; idx < count; ++idx)
+    PointId idx = view->size();
+    for (point_count_t i = 0; i < count; ++i, ++idx, ++m_index)
     {
         double x;
         double y;
@@ -172,9 +175,9 @@ point_count_t FauxReader::read(PointViewPtr view, point_count_t count)
                 z = m_minZ;
                 break;
             case Ramp:
-                x = m_minX + delX * idx;
-                y = m_minY + delY * idx;
-                z = m_minZ + delZ * idx;
+                x = m_minX + delX * m_index;
+                y = m_minY + delY * m_index;
+                z = m_minZ + delZ * m_index;
                 break;
             case Uniform:
                 x = Utils::uniform(m_minX, m_maxX, seed++);
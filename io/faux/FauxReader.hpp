@@ -91,6 +91,10 @@ public:
 
     static Dimension::IdList getDefaultDimensions();
     Options getDefaultOptions();
+    virtual point_count_t numPoints() const
+        { return m_count; }
+    virtual bool streamable() const
+        { return true; }
 
 private:
     Mode m_mode;
@@ -107,6 +111,7 @@ private:
     double m_stdev_y;
     double m_stdev_z;
     uint64_t m_time;
+    point_count_t m_index;
     int m_numReturns;
     int m_returnNum;
 
@@ -116,6 +121,7 @@ private:
     {
         m_returnNum = 1;
         m_time = 0;
+        m_index = 0;
     }
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual bool eof()
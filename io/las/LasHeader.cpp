@@ -120,7 +120,7 @@ void LasHeader::setOffset(double x, double y, double z)
 }
 
 
-uint16_t LasHeader::basePointLen(uint8_t type)
+uint16_t LasHeader::basePointLen(uint8_t type) const
 {
     switch (type)
     {
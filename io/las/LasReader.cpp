@@ -34,6 +34,7 @@
 
 #include "LasReader.hpp"
 
+#include <limits>
 #include <sstream>
 #include <string.h>
 
@@ -63,12 +64,131 @@ public:
         {}
 };
 
+// Points are decoded this many at a time, one field at a time.
+const point_count_t DecodePoints = 1024;
+
+// What each supported point format holds, so that a decoder can be built
+// for each one.
+template<int FORMAT>
+struct LasFormat
+{
+    static const bool V14 = (FORMAT > 5);
+    static const bool Time = (FORMAT == 1 || FORMAT >= 3);
+    static const bool Color = (FORMAT == 2 || FORMAT == 3 || FORMAT == 7 ||
+        FORMAT == 8);
+    static const bool Infrared = (FORMAT == 8);
+
+    // Offsets of the fields in a record.
+    static const size_t ReturnOffset = 14;
+    static const size_t FlagsOffset = V14 ? 15 : 14;
+    static const size_t ClassOffset = V14 ? 16 : 15;
+    static const size_t ScanAngleOffset = V14 ? 18 : 16;
+    static const size_t UserOffset = 17;
+    static const size_t PointSourceOffset = V14 ? 20 : 18;
+    static const size_t TimeOffset = V14 ? 22 : 20;
+    static const size_t ColorOffset = V14 ? 30 : (Time ? 28 : 20);
+    static const size_t InfraredOffset = 36;
+};
+
+template<typename T>
+inline T fieldAt(const char *pos)
+{
+    T v;
+    LeExtractor in(pos, sizeof(T));
+    in >> v;
+    return v;
+}
+
+// Copy a field out of 'count' records.
+template<typename T, typename OUT>
+void column(const char *buf, size_t pointLen, size_t offset,
+    point_count_t count, OUT *out)
+{
+    buf += offset;
+    for (point_count_t i = 0; i < count; ++i, buf += pointLen)
+        out[i] = (OUT)fieldAt<T>(buf);
+}
+
+// Copy a coordinate out of 'count' records and scale it.  The scaling is
+// a separate loop over contiguous values so that it can be vectorized.
+void coordinate(const char *buf, size_t pointLen, size_t offset,
+    point_count_t count, double scale, double shift, double *out)
+{
+    int32_t ints[DecodePoints];
+    column<int32_t>(buf, pointLen, offset, count, ints);
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] = ints[i] * scale + shift;
+}
+
+// A run of packed point records added to a view.
+struct RowSpan
+{
+    char *m_buf;
+    point_count_t m_count;
+};
+typedef std::vector<RowSpan> RowSpans;
+
+// Add 'count' points to the end of the view as runs of packed records, so
+// that their fields can be written straight into the records.  If the
+// table doesn't store packed records, 'rows' is left empty and any points
+// that weren't added are added when they're first set.
+void appendRows(PointView& view, point_count_t count, RowSpans& rows)
+{
+    rows.clear();
+    while (count)
+    {
+        char *buf = NULL;
+        point_count_t cnt = view.appendSpan(count, buf);
+        if (cnt == 0 || buf == NULL)
+        {
+            rows.clear();
+            return;
+        }
+        rows.push_back({ buf, cnt });
+        count -= cnt;
+    }
+}
+
+template<typename T>
+void store(PointView& view, const DimAccessor<T>& acc, PointId first,
+    const RowSpans& rows, const T *vals, point_count_t count)
+{
+    if (rows.empty())
+    {
+        for (point_count_t i = 0; i < count; ++i)
+            acc.set(view, first + i, vals[i]);
+        return;
+    }
+    for (const RowSpan& r : rows)
+    {
+        acc.setSpan(r.m_buf, r.m_count, vals);
+        vals += r.m_count;
+    }
+}
+
+// Number of values that aren't between 1 and 5, counted without branching.
+unsigned countInvalidReturns(const uint8_t *vals, point_count_t count)
+{
+    unsigned bad = 0;
+    for (point_count_t i = 0; i < count; ++i)
+        bad += (unsigned)(vals[i] - 1) > 4;
+    return bad;
+}
+
 } // unnamed namespace
 
 void LasReader::processOptions(const Options& options)
 {
     StringList extraDims = options.getValueOrDefault<StringList>("extra_dims");
     m_extraDims = LasUtils::parse(extraDims);
+    m_start = options.getValueOrDefault<point_count_t>("start", 0);
+    m_threads = options.getValueOrDefault<size_t>("threads", 1);
+    if (m_threads == 0)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'threads' must be at least 1.";
+        throw pdal_error(oss.str());
+    }
 
     m_error.setFilename(m_filename);
 }
@@ -165,7 +285,21 @@ void LasReader::ready(PointTableRef table, MetadataNode& m)
         VariableLengthRecord *vlr = findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
         m_zipPoint.reset(new ZipPoint(vlr));
 
-        if (!m_unzipper)
+        // Chunks of points are decompressed concurrently when there's more
+        // than one thread.  LAS embedded in other files is read serially,
+        // since the chunk table is located relative to the start of the
+        // LAS data.  So are files with more points than LASzip can seek
+        // to, since each chunk is found by seeking to its first point.
+        m_parallelUnzipper.reset();
+        if (m_threads > 1 && fileOffset() == 0 &&
+            getNumPoints() <= (std::numeric_limits<uint32_t>::max)() &&
+            ParallelUnzipper::chunked(*m_zipPoint->GetZipper()))
+        {
+            m_parallelUnzipper.reset(new ParallelUnzipper(m_filename,
+                m_lasHeader.pointOffset(), vlr, getNumPoints(),
+                m_lasHeader.pointLen(), m_threads));
+        }
+        else if (!m_unzipper)
         {
             m_unzipper.reset(new LASunzipper());
 
@@ -187,8 +321,41 @@ void LasReader::ready(PointTableRef table, MetadataNode& m)
         throw pdal_error("LASzip is not enabled.  Can't read LAZ data.");
 #endif
     }
+    else
+    {
+        // Uncompressed points are decoded straight out of a mapping of the
+        // file if it can be mapped, and read through the stream if not.
+        FileUtils::unmapFile(m_map);
+        m_map = FileUtils::mapFile(m_filename);
+        if (!m_map.m_addr)
+            log()->get(LogLevel::Debug) << getName() << ": Can't map '" <<
+                m_filename << "' (" << m_map.m_error << ").  Reading "
+                "points from a stream." << std::endl;
+    }
     m_error.setLog(log());
+    seek(m_start);
 
+    using namespace Dimension;
+
+    PointLayoutPtr layout = table.layout();
+    m_acc.m_x.init(layout, Id::X);
+    m_acc.m_y.init(layout, Id::Y);
+    m_acc.m_z.init(layout, Id::Z);
+    m_acc.m_intensity.init(layout, Id::Intensity);
+    m_acc.m_returnNum.init(layout, Id::ReturnNumber);
+    m_acc.m_numReturns.init(layout, Id::NumberOfReturns);
+    m_acc.m_scanChannel.init(layout, Id::ScanChannel);
+    m_acc.m_scanDirFlag.init(layout, Id::ScanDirectionFlag);
+    m_acc.m_flight.init(layout, Id::EdgeOfFlightLine);
+    m_acc.m_classification.init(layout, Id::Classification);
+    m_acc.m_scanAngle.init(layout, Id::ScanAngleRank);
+    m_acc.m_user.init(layout, Id::UserData);
+    m_acc.m_pointSourceId.init(layout, Id::PointSourceId);
+    m_acc.m_gpsTime.init(layout, Id::GpsTime);
+    m_acc.m_red.init(layout, Id::Red);
+    m_acc.m_green.init(layout, Id::Green);
+    m_acc.m_blue.init(layout, Id::Blue);
+    m_acc.m_infrared.init(layout, Id::Infrared);
 }
 
 
@@ -198,6 +365,9 @@ Options LasReader::getDefaultOptions()
     options.add("filename", "", "file to read from");
     options.add("extra_dims", "", "Extra dimensions not part of the LAS "
         "point format to be read from each point.");
+    options.add("start", 0, "Position of the first point to read.");
+    options.add("threads", 1, "Number of threads to decompress LAZ data "
+        "with.");
     return options;
 }
 
@@ -490,33 +660,49 @@ void LasReader::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Id::X, Type::Double);
     layout->registerDim(Id::Y, Type::Double);
     layout->registerDim(Id::Z, Type::Double);
-    layout->registerDim(Id::Intensity, Type::Unsigned16);
-    layout->registerDim(Id::ReturnNumber, Type::Unsigned8);
-    layout->registerDim(Id::NumberOfReturns, Type::Unsigned8);
-    layout->registerDim(Id::ScanDirectionFlag, Type::Unsigned8);
-    layout->registerDim(Id::EdgeOfFlightLine, Type::Unsigned8);
-    layout->registerDim(Id::Classification, Type::Unsigned8);
-    layout->registerDim(Id::ScanAngleRank, Type::Float);
-    layout->registerDim(Id::UserData, Type::Unsigned8);
-    layout->registerDim(Id::PointSourceId, Type::Unsigned16);
-
-    if (m_lasHeader.hasTime())
-        layout->registerDim(Id::GpsTime, Type::Double);
+
+    // Other dimensions are only registered (and decoded) if a later stage
+    // reads them.
+    auto registerNeeded = [this, layout](Id::Enum id, Type::Enum type)
+    {
+        if (!dimNeeded(id))
+            return false;
+        layout->registerDim(id, type);
+        return true;
+    };
+
+    bool attrs = false;
+    attrs |= registerNeeded(Id::Intensity, Type::Unsigned16);
+    attrs |= registerNeeded(Id::ReturnNumber, Type::Unsigned8);
+    attrs |= registerNeeded(Id::NumberOfReturns, Type::Unsigned8);
+    attrs |= registerNeeded(Id::ScanDirectionFlag, Type::Unsigned8);
+    attrs |= registerNeeded(Id::EdgeOfFlightLine, Type::Unsigned8);
+    attrs |= registerNeeded(Id::Classification, Type::Unsigned8);
+    attrs |= registerNeeded(Id::ScanAngleRank, Type::Float);
+    attrs |= registerNeeded(Id::UserData, Type::Unsigned8);
+    attrs |= registerNeeded(Id::PointSourceId, Type::Unsigned16);
+    if (m_lasHeader.versionAtLeast(1, 4))
+        attrs |= registerNeeded(Id::ScanChannel, defaultType(Id::ScanChannel));
+    m_loadAttrs = attrs;
+
+    m_loadTime = m_lasHeader.hasTime() && registerNeeded(Id::GpsTime,
+        Type::Double);
+
+    m_loadColor = false;
     if (m_lasHeader.hasColor())
     {
-        layout->registerDim(Id::Red, Type::Unsigned16);
-        layout->registerDim(Id::Green, Type::Unsigned16);
-        layout->registerDim(Id::Blue, Type::Unsigned16);
+        m_loadColor |= registerNeeded(Id::Red, Type::Unsigned16);
+        m_loadColor |= registerNeeded(Id::Green, Type::Unsigned16);
+        m_loadColor |= registerNeeded(Id::Blue, Type::Unsigned16);
     }
     if (m_lasHeader.hasInfrared())
-        layout->registerDim(Id::Infrared);
-    if (m_lasHeader.versionAtLeast(1, 4))
-        layout->registerDim(Id::ScanChannel);
+        registerNeeded(Id::Infrared, defaultType(Id::Infrared));
 
     for (auto& dim : m_extraDims)
     {
+        dim.m_dimType.m_id = Id::Unknown;
         Dimension::Type::Enum type = dim.m_dimType.m_type;
-        if (type == Dimension::Type::None)
+        if (type == Dimension::Type::None || !dimNeeded(dim.m_name))
             continue;
         if (dim.m_dimType.m_xform.nonstandard())
             type = Dimension::Type::Double;
@@ -534,28 +720,59 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
     if (m_zipPoint)
     {
 #ifdef PDAL_HAVE_LASZIP
-        for (i = 0; i < count; i++)
+        if (m_parallelUnzipper)
         {
-            if (!m_unzipper->read(m_zipPoint->m_lz_point))
+            while (i < count)
             {
-                std::string error = "Error reading compressed point data: ";
-                const char* err = m_unzipper->get_error();
-                if (!err)
-                    err = "(unknown error)";
-                error += err;
-                throw pdal_error(error);
+                point_count_t cnt = count - i;
+                const char *pos = m_parallelUnzipper->next(cnt);
+                if (cnt == 0)
+                    throw pdal_error("Compressed point data ended before "
+                        "the number of points in the header.");
+                decodePoints(*view, pos, cnt);
+                i += cnt;
             }
-            loadPoint(*view.get(), (char *)m_zipPoint->m_lz_point_data.data(),
+        }
+        else
+        {
+            // Points are decompressed into a block and decoded together.
+            std::vector<char> buf(std::min(count, DecodePoints) *
                 pointByteCount);
+            while (i < count)
+            {
+                point_count_t cnt = std::min(count - i, DecodePoints);
+                for (point_count_t j = 0; j < cnt; ++j)
+                {
+                    if (!m_unzipper->read(m_zipPoint->m_lz_point))
+                    {
+                        std::string error = "Error reading compressed "
+                            "point data: ";
+                        const char* err = m_unzipper->get_error();
+                        if (!err)
+                            err = "(unknown error)";
+                        error += err;
+                        throw pdal_error(error);
+                    }
+                    memcpy(buf.data() + j * pointByteCount,
+                        m_zipPoint->m_lz_point_data.data(), pointByteCount);
+                }
+                decodePoints(*view, buf.data(), cnt);
+                i += cnt;
+            }
         }
 #else
         throw pdal_error("LASzip is not enabled for this "
             "LasReader::processBuffer");
 #endif
     }
+    else if (m_map.m_addr)
+        i = readMapped(*view, count);
     else
     {
-        m_istream->seekg(m_lasHeader.pointOffset());
+        // Points may have been read by a previous call, so position the
+        // stream at the next unread point.
+        m_istream->seekg(m_lasHeader.pointOffset() +
+            m_index * pointByteCount);
         point_count_t remaining = count;
 
         // Make a buffer at most a meg.
@@ -568,13 +785,8 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             {
                 point_count_t blockPoints = readFileBlock(buf, remaining);
                 remaining -= blockPoints;
-                char *pos = buf.data();
-                while (blockPoints--)
-                {
-                    loadPoint(*view.get(), pos, pointByteCount);
-                    pos += pointByteCount;
-                    i++;
-                }
+                decodePoints(*view, buf.data(), blockPoints);
+                i += blockPoints;
             } while (remaining);
         }
         catch (std::out_of_range&)
@@ -587,6 +799,39 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 }
 
 
+// Decode points straight out of the mapped file.  The system is asked to
+// read each block of points ahead of the one being decoded.
+point_count_t LasReader::readMapped(PointView& view, point_count_t count)
+{
+    const size_t BlockBytes = 1 << 22;
+
+    size_t pointLen = m_lasHeader.pointLen();
+    uint64_t start = fileOffset() + m_lasHeader.pointOffset() +
+        m_index * pointLen;
+    // A truncated file has fewer points than the header says.
+    if (start >= m_map.m_size)
+        return 0;
+    count = (std::min)(count, (point_count_t)((m_map.m_size - start) /
+        pointLen));
+
+    point_count_t blockPoints =
+        (std::max)((point_count_t)1, (point_count_t)(BlockBytes / pointLen));
+    uint64_t offset = start;
+    FileUtils::prefetch(m_map, offset, blockPoints * pointLen);
+    for (point_count_t remaining = count; remaining;)
+    {
+        point_count_t cnt = (std::min)(blockPoints, remaining);
+        size_t size = cnt * pointLen;
+        FileUtils::prefetch(m_map, offset + size, blockPoints * pointLen);
+
+        decodePoints(view, m_map.m_addr + offset, cnt);
+        offset += size;
+        remaining -= cnt;
+    }
+    return count;
+}
+
+
 point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t maxpoints)
 {
@@ -609,16 +854,284 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
 }
 
 
-void LasReader::loadPoint(PointView& data, char *buf, size_t bufsize)
+// Make 'idx' the next point to be read.  Compressed points are found by
+// jumping to the chunk that holds the point using the file's chunk table,
+// so only the points before it in that chunk are decompressed.  Called
+// after prepare() and before execute(), this sets the point that reading
+// starts at, as the 'start' option does.
+void LasReader::seek(PointId idx)
+{
+    if (idx > getNumPoints())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Can't seek to point " << idx << " of '" <<
+            m_filename << "', which has " << getNumPoints() << " points.";
+        throw pdal_error(oss.str());
+    }
+
+#ifdef PDAL_HAVE_LASZIP
+    // LASzip only seeks to 32-bit point indexes.
+    if ((m_parallelUnzipper || m_unzipper) &&
+        idx > (std::numeric_limits<uint32_t>::max)())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Can't seek to point " << idx << " of '" <<
+            m_filename << "'.  Compressed points can only be sought up to "
+            "point " << (std::numeric_limits<uint32_t>::max)() << ".";
+        throw pdal_error(oss.str());
+    }
+    if (m_parallelUnzipper)
+    {
+        // Don't decompress chunks past the last point to be read.
+        point_count_t end = getNumPoints();
+        if (m_count < end - idx)
+            end = idx + m_count;
+        m_parallelUnzipper->seek(idx, end);
+    }
+    else if (m_unzipper && !m_unzipper->seek((unsigned)idx))
+    {
+        std::ostringstream oss;
+        const char* err = m_unzipper->get_error();
+        if (err == NULL)
+            err = "(unknown error)";
+        oss << "Failed to seek in LASzip stream: " << std::string(err);
+        throw pdal_error(oss.str());
+    }
+#endif
+    m_start = idx;
+    m_index = idx;
+}
+
+
+// Predicates can be checked for the fields that every point format has.
+bool LasReader::acceptsPredicate(const DimPredicate& pred) const
+{
+    using namespace Dimension;
+
+    switch (pred.m_id)
+    {
+    case Id::X:
+    case Id::Y:
+    case Id::Z:
+    case Id::Intensity:
+    case Id::ReturnNumber:
+    case Id::NumberOfReturns:
+    case Id::ScanDirectionFlag:
+    case Id::EdgeOfFlightLine:
+    case Id::Classification:
+    case Id::ScanAngleRank:
+    case Id::UserData:
+    case Id::PointSourceId:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+// Decode 'count' point records into the view with the decoder for the
+// file's point format.  With predicates, points may be skipped, so they're
+// decoded one at a time.  The formats with wave packets (4, 5, 9 and 10)
+// have no decoder because initialize() rejects them.
+void LasReader::decodePoints(PointView& view, const char *buf,
+    point_count_t count)
+{
+    size_t pointLen = m_lasHeader.pointLen();
+    if (pushedPredicates().size())
+    {
+        for (point_count_t i = 0; i < count; ++i, buf += pointLen)
+            loadPoint(view, buf, pointLen);
+        return;
+    }
+
+    while (count)
+    {
+        point_count_t cnt = std::min(count, DecodePoints);
+        switch (m_lasHeader.pointFormat())
+        {
+        case 0:
+            decodeBlock<0>(view, buf, cnt);
+            break;
+        case 1:
+            decodeBlock<1>(view, buf, cnt);
+            break;
+        case 2:
+            decodeBlock<2>(view, buf, cnt);
+            break;
+        case 3:
+            decodeBlock<3>(view, buf, cnt);
+            break;
+        case 6:
+            decodeBlock<6>(view, buf, cnt);
+            break;
+        case 7:
+            decodeBlock<7>(view, buf, cnt);
+            break;
+        case 8:
+            decodeBlock<8>(view, buf, cnt);
+            break;
+        default:
+            // Not reached for any format that passes initialize().
+            for (point_count_t i = 0; i < cnt; ++i)
+                loadPoint(view, buf + i * pointLen, pointLen);
+            break;
+        }
+        buf += cnt * pointLen;
+        count -= cnt;
+    }
+}
+
+
+// Decode up to DecodePoints records of a point format.  Each field is
+// copied out of all the records before the next one, and what the format
+// holds is known at compile time, so the loops have no per-point tests.
+template<int FORMAT>
+void LasReader::decodeBlock(PointView& view, const char *buf,
+    point_count_t count)
+{
+    typedef LasFormat<FORMAT> F;
+
+    const LasHeader& h = m_lasHeader;
+    const size_t len = h.pointLen();
+    const PointId first = view.size();
+
+    // Fields are written straight into the points' records when the table
+    // stores packed records.  Otherwise the points are added to the view
+    // when X is set.
+    RowSpans rows;
+    appendRows(view, count, rows);
+
+    double d[DecodePoints];
+    coordinate(buf, len, 0, count, h.scaleX(), h.offsetX(), d);
+    store(view, m_acc.m_x, first, rows, d, count);
+    coordinate(buf, len, 4, count, h.scaleY(), h.offsetY(), d);
+    store(view, m_acc.m_y, first, rows, d, count);
+    coordinate(buf, len, 8, count, h.scaleZ(), h.offsetZ(), d);
+    store(view, m_acc.m_z, first, rows, d, count);
+
+    if (m_loadAttrs)
+    {
+        uint16_t u16[DecodePoints];
+        uint8_t bits[DecodePoints];
+        uint8_t u8[DecodePoints];
+
+        column<uint16_t>(buf, len, 12, count, u16);
+        store(view, m_acc.m_intensity, first, rows, u16, count);
+
+        if (F::V14)
+        {
+            column<uint8_t>(buf, len, F::ReturnOffset, count, bits);
+            for (point_count_t i = 0; i < count; ++i)
+                u8[i] = bits[i] & 0x0F;
+            store(view, m_acc.m_returnNum, first, rows, u8, count);
+            for (point_count_t i = 0; i < count; ++i)
+                u8[i] = (bits[i] >> 4) & 0x0F;
+            store(view, m_acc.m_numReturns, first, rows, u8, count);
+
+            column<uint8_t>(buf, len, F::FlagsOffset, count, bits);
+            for (point_count_t i = 0; i < count; ++i)
+                u8[i] = (bits[i] >> 4) & 0x03;
+            store(view, m_acc.m_scanChannel, first, rows, u8, count);
+        }
+        else
+        {
+            column<uint8_t>(buf, len, F::FlagsOffset, count, bits);
+            for (point_count_t i = 0; i < count; ++i)
+                u8[i] = bits[i] & 0x07;
+            if (countInvalidReturns(u8, count))
+                for (point_count_t i = 0; i < count; ++i)
+                    if (u8[i] == 0 || u8[i] > 5)
+                        m_error.returnNumWarning(u8[i]);
+            store(view, m_acc.m_returnNum, first, rows, u8, count);
+
+            for (point_count_t i = 0; i < count; ++i)
+                u8[i] = (bits[i] >> 3) & 0x07;
+            if (countInvalidReturns(u8, count))
+                for (point_count_t i = 0; i < count; ++i)
+                    if (u8[i] == 0 || u8[i] > 5)
+                        m_error.numReturnsWarning(u8[i]);
+            store(view, m_acc.m_numReturns, first, rows, u8, count);
+        }
+        for (point_count_t i = 0; i < count; ++i)
+            u8[i] = (bits[i] >> 6) & 0x01;
+        store(view, m_acc.m_scanDirFlag, first, rows, u8, count);
+        for (point_count_t i = 0; i < count; ++i)
+            u8[i] = (bits[i] >> 7) & 0x01;
+        store(view, m_acc.m_flight, first, rows, u8, count);
+
+        column<uint8_t>(buf, len, F::ClassOffset, count, u8);
+        store(view, m_acc.m_classification, first, rows, u8, count);
+
+        if (F::V14)
+        {
+            column<int16_t>(buf, len, F::ScanAngleOffset, count, d);
+            for (point_count_t i = 0; i < count; ++i)
+                d[i] *= .006;
+        }
+        else
+            column<int8_t>(buf, len, F::ScanAngleOffset, count, d);
+        store(view, m_acc.m_scanAngle, first, rows, d, count);
+
+        column<uint8_t>(buf, len, F::UserOffset, count, u8);
+        store(view, m_acc.m_user, first, rows, u8, count);
+        column<uint16_t>(buf, len, F::PointSourceOffset, count, u16);
+        store(view, m_acc.m_pointSourceId, first, rows, u16, count);
+    }
+
+    if (F::Time && m_loadTime)
+    {
+        column<double>(buf, len, F::TimeOffset, count, d);
+        store(view, m_acc.m_gpsTime, first, rows, d, count);
+    }
+
+    if (F::Color && m_loadColor)
+    {
+        uint16_t u16[DecodePoints];
+
+        column<uint16_t>(buf, len, F::ColorOffset, count, u16);
+        store(view, m_acc.m_red, first, rows, u16, count);
+        column<uint16_t>(buf, len, F::ColorOffset + 2, count, u16);
+        store(view, m_acc.m_green, first, rows, u16, count);
+        column<uint16_t>(buf, len, F::ColorOffset + 4, count, u16);
+        store(view, m_acc.m_blue, first, rows, u16, count);
+    }
+
+    if (F::Infrared)
+    {
+        uint16_t u16[DecodePoints];
+
+        column<uint16_t>(buf, len, F::InfraredOffset, count, u16);
+        store(view, m_acc.m_infrared, first, rows, u16, count);
+    }
+
+    if (m_extraDims.size())
+    {
+        size_t base = h.basePointLen(FORMAT);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            LeExtractor in(buf + i * len + base, len - base);
+            loadExtraDims(in, view, first + i);
+        }
+    }
+
+    if (m_cb)
+        for (point_count_t i = 0; i < count; ++i)
+            m_cb(view, first + i);
+}
+
+
+// Returns false if the point was skipped because it failed a predicate.
+bool LasReader::loadPoint(PointView& data, const char *buf, size_t bufsize)
 {
     if (m_lasHeader.has14Format())
-        loadPointV14(data, buf, bufsize);
+        return loadPointV14(data, buf, bufsize);
     else
-        loadPointV10(data, buf, bufsize);
+        return loadPointV10(data, buf, bufsize);
 }
 
 
-void LasReader::loadPointV10(PointView& data, char *buf, size_t bufsize)
+bool LasReader::loadPointV10(PointView& data, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -654,42 +1167,81 @@ void LasReader::loadPointV10(PointView& data, char *buf, size_t bufsize)
     if (numReturns == 0 || numReturns > 5)
         m_error.numReturnsWarning(numReturns);
 
+    auto value = [&](Dimension::Id::Enum id) -> double
+    {
+        using namespace Dimension;
+
+        switch (id)
+        {
+        case Id::X: return x;
+        case Id::Y: return y;
+        case Id::Z: return z;
+        case Id::Intensity: return intensity;
+        case Id::ReturnNumber: return returnNum;
+        case Id::NumberOfReturns: return numReturns;
+        case Id::ScanDirectionFlag: return scanDirFlag;
+        case Id::EdgeOfFlightLine: return flight;
+        case Id::Classification: return classification;
+        case Id::ScanAngleRank: return scanAngleRank;
+        case Id::UserData: return user;
+        case Id::PointSourceId: return pointSourceId;
+        default: return 0;
+        }
+    };
+    if (!passes(pushedPredicates(), value))
+        return false;
+
     data.setField(Dimension::Id::X, nextId, x);
     data.setField(Dimension::Id::Y, nextId, y);
     data.setField(Dimension::Id::Z, nextId, z);
-    data.setField(Dimension::Id::Intensity, nextId, intensity);
-    data.setField(Dimension::Id::ReturnNumber, nextId, returnNum);
-    data.setField(Dimension::Id::NumberOfReturns, nextId, numReturns);
-    data.setField(Dimension::Id::ScanDirectionFlag, nextId, scanDirFlag);
-    data.setField(Dimension::Id::EdgeOfFlightLine, nextId, flight);
-    data.setField(Dimension::Id::Classification, nextId, classification);
-    data.setField(Dimension::Id::ScanAngleRank, nextId, scanAngleRank);
-    data.setField(Dimension::Id::UserData, nextId, user);
-    data.setField(Dimension::Id::PointSourceId, nextId, pointSourceId);
+    if (m_loadAttrs)
+    {
+        data.setField(Dimension::Id::Intensity, nextId, intensity);
+        data.setField(Dimension::Id::ReturnNumber, nextId, returnNum);
+        data.setField(Dimension::Id::NumberOfReturns, nextId, numReturns);
+        data.setField(Dimension::Id::ScanDirectionFlag, nextId, scanDirFlag);
+        data.setField(Dimension::Id::EdgeOfFlightLine, nextId, flight);
+        data.setField(Dimension::Id::Classification, nextId, classification);
+        data.setField(Dimension::Id::ScanAngleRank, nextId, scanAngleRank);
+        data.setField(Dimension::Id::UserData, nextId, user);
+        data.setField(Dimension::Id::PointSourceId, nextId, pointSourceId);
+    }
 
     if (h.hasTime())
     {
-        double time;
-        istream >> time;
-        data.setField(Dimension::Id::GpsTime, nextId, time);
+        if (m_loadTime)
+        {
+            double time;
+            istream >> time;
+            data.setField(Dimension::Id::GpsTime, nextId, time);
+        }
+        else
+            istream.skip(sizeof(double));
     }
 
     if (h.hasColor())
     {
-        uint16_t red, green, blue;
-        istream >> red >> green >> blue;
-        data.setField(Dimension::Id::Red, nextId, red);
-        data.setField(Dimension::Id::Green, nextId, green);
-        data.setField(Dimension::Id::Blue, nextId, blue);
+        if (m_loadColor)
+        {
+            uint16_t red, green, blue;
+            istream >> red >> green >> blue;
+            data.setField(Dimension::Id::Red, nextId, red);
+            data.setField(Dimension::Id::Green, nextId, green);
+            data.setField(Dimension::Id::Blue, nextId, blue);
+        }
+        else
+            istream.skip(3 * sizeof(uint16_t));
     }
 
     if (m_extraDims.size())
         loadExtraDims(istream, data, nextId);
     if (m_cb)
         m_cb(data, nextId);
+    return true;
 }
 
-void LasReader::loadPointV14(PointView& data, char *buf, size_t bufsize)
+bool LasReader::loadPointV14(PointView& data, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -723,29 +1275,63 @@ void LasReader::loadPointV14(PointView& data, char *buf, size_t bufsize)
     uint8_t scanDirFlag = (flags >> 6) & 0x01;
     uint8_t flight = (flags >> 7) & 0x01;
 
+    auto value = [&](Dimension::Id::Enum id) -> double
+    {
+        using namespace Dimension;
+
+        switch (id)
+        {
+        case Id::X: return x;
+        case Id::Y: return y;
+        case Id::Z: return z;
+        case Id::Intensity: return intensity;
+        case Id::ReturnNumber: return returnNum;
+        case Id::NumberOfReturns: return numReturns;
+        case Id::ScanDirectionFlag: return scanDirFlag;
+        case Id::EdgeOfFlightLine: return flight;
+        case Id::Classification: return classification;
+        // The scan angle is stored as a float.
+        case Id::ScanAngleRank: return (float)(scanAngle * .006);
+        case Id::UserData: return user;
+        case Id::PointSourceId: return pointSourceId;
+        default: return 0;
+        }
+    };
+    if (!passes(pushedPredicates(), value))
+        return false;
+
     //ABELL - Need to do something with the classFlags;
     data.setField(Dimension::Id::X, nextId, x);
     data.setField(Dimension::Id::Y, nextId, y);
     data.setField(Dimension::Id::Z, nextId, z);
-    data.setField(Dimension::Id::Intensity, nextId, intensity);
-    data.setField(Dimension::Id::ReturnNumber, nextId, returnNum);
-    data.setField(Dimension::Id::NumberOfReturns, nextId, numReturns);
-    data.setField(Dimension::Id::ScanChannel, nextId, scanChannel);
-    data.setField(Dimension::Id::ScanDirectionFlag, nextId, scanDirFlag);
-    data.setField(Dimension::Id::EdgeOfFlightLine, nextId, flight);
-    data.setField(Dimension::Id::Classification, nextId, classification);
-    data.setField(Dimension::Id::ScanAngleRank, nextId, scanAngle * .006);
-    data.setField(Dimension::Id::UserData, nextId, user);
-    data.setField(Dimension::Id::PointSourceId, nextId, pointSourceId);
-    data.setField(Dimension::Id::GpsTime, nextId, gpsTime);
+    if (m_loadAttrs)
+    {
+        data.setField(Dimension::Id::Intensity, nextId, intensity);
+        data.setField(Dimension::Id::ReturnNumber, nextId, returnNum);
+        data.setField(Dimension::Id::NumberOfReturns, nextId, numReturns);
+        data.setField(Dimension::Id::ScanChannel, nextId, scanChannel);
+        data.setField(Dimension::Id::ScanDirectionFlag, nextId, scanDirFlag);
+        data.setField(Dimension::Id::EdgeOfFlightLine, nextId, flight);
+        data.setField(Dimension::Id::Classification, nextId, classification);
+        data.setField(Dimension::Id::ScanAngleRank, nextId, scanAngle * .006);
+        data.setField(Dimension::Id::UserData, nextId, user);
+        data.setField(Dimension::Id::PointSourceId, nextId, pointSourceId);
+    }
+    if (m_loadTime)
+        data.setField(Dimension::Id::GpsTime, nextId, gpsTime);
 
     if (h.hasColor())
     {
-        uint16_t red, green, blue;
-        istream >> red >> green >> blue;
-        data.setField(Dimension::Id::Red, nextId, red);
-        data.setField(Dimension::Id::Green, nextId, green);
-        data.setField(Dimension::Id::Blue, nextId, blue);
+        if (m_loadColor)
+        {
+            uint16_t red, green, blue;
+            istream >> red >> green >> blue;
+            data.setField(Dimension::Id::Red, nextId, red);
+            data.setField(Dimension::Id::Green, nextId, green);
+            data.setField(Dimension::Id::Blue, nextId, blue);
+        }
+        else
+            istream.skip(3 * sizeof(uint16_t));
     }
 
     if (h.hasInfrared())
@@ -758,6 +1344,9 @@ void LasReader::loadPointV14(PointView& data, char *buf, size_t bufsize)
 
     if (m_extraDims.size())
         loadExtraDims(istream, data, nextId);
+    if (m_cb)
+        m_cb(data, nextId);
+    return true;
 }
 
 
@@ -767,8 +1356,10 @@ void LasReader::loadExtraDims(LeExtractor& istream, PointView& data,
     Everything e;
     for (auto& dim : m_extraDims)
     {
-        // Dimension type of None is undefined and unprocessed
-        if (dim.m_dimType.m_type == Dimension::Type::None)
+        // Dimension type of None is undefined and unprocessed.  Other
+        // dimensions are skipped if nothing downstream reads them.
+        if (dim.m_dimType.m_type == Dimension::Type::None ||
+            dim.m_dimType.m_id == Dimension::Id::Unknown)
         {
             istream.skip(dim.m_size);
             continue;
@@ -792,10 +1383,12 @@ void LasReader::loadExtraDims(LeExtractor& istream, PointView& data,
 void LasReader::done(PointTableRef)
 {
 #ifdef PDAL_HAVE_LASZIP
+    m_parallelUnzipper.reset();
     m_zipPoint.reset();
     m_unzipper.reset();
 #endif
     destroyStream();
+    FileUtils::unmapFile(m_map);
     m_initialized = false;
 }
 
@@ -35,11 +35,13 @@
 #pragma once
 
 #include <pdal/pdal_export.hpp>
+#include <pdal/DimAccessor.hpp>
 #include <pdal/Reader.hpp>
 
 #include "LasError.hpp"
 #include "LasHeader.hpp"
 #include "LasUtils.hpp"
+#include "ParallelUnzipper.hpp"
 #include "ZipPoint.hpp"
 
 extern "C" int32_t LasReader_ExitFunc();
@@ -57,11 +59,16 @@ class PDAL_DLL LasReader : public pdal::Reader
 {
     friend class NitfReader;
 public:
-    LasReader() : pdal::Reader(), m_index(0), m_istream(NULL), m_initialized(false)
+    LasReader() : pdal::Reader(), m_index(0), m_start(0), m_istream(NULL),
+        m_threads(1), m_initialized(false), m_loadAttrs(true),
+        m_loadTime(true), m_loadColor(true)
         {}
 
     virtual ~LasReader()
-        {  destroyStream(); }
+    {
+        destroyStream();
+        FileUtils::unmapFile(m_map);
+    }
 
     static void * create();
     static int32_t destroy(void *);
@@ -73,6 +80,13 @@ public:
         { return m_lasHeader; }
     point_count_t getNumPoints() const
         { return m_lasHeader.pointCount(); }
+    // Points from the starting point on.
+    virtual point_count_t numPoints() const
+        { return getNumPoints() - (std::min)(m_start, getNumPoints()); }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool acceptsPredicate(const DimPredicate& pred) const;
+    void seek(PointId idx);
 
 protected:
     virtual std::istream *createStream()
@@ -96,15 +110,50 @@ protected:
                 m_initialized = false;
             }
         }
+    // Position of the LAS data in the file, for LAS embedded in other
+    // formats.
+    virtual uint64_t fileOffset() const
+        { return 0; }
 private:
+    // Where decoded points are stored.  Dimensions that aren't in the
+    // layout are skipped when set.
+    struct Accessors
+    {
+        DimAccessor<double> m_x;
+        DimAccessor<double> m_y;
+        DimAccessor<double> m_z;
+        DimAccessor<uint16_t> m_intensity;
+        DimAccessor<uint8_t> m_returnNum;
+        DimAccessor<uint8_t> m_numReturns;
+        DimAccessor<uint8_t> m_scanChannel;
+        DimAccessor<uint8_t> m_scanDirFlag;
+        DimAccessor<uint8_t> m_flight;
+        DimAccessor<uint8_t> m_classification;
+        DimAccessor<double> m_scanAngle;
+        DimAccessor<uint8_t> m_user;
+        DimAccessor<uint16_t> m_pointSourceId;
+        DimAccessor<double> m_gpsTime;
+        DimAccessor<uint16_t> m_red;
+        DimAccessor<uint16_t> m_green;
+        DimAccessor<uint16_t> m_blue;
+        DimAccessor<uint16_t> m_infrared;
+    };
+
     LasError m_error;
     LasHeader m_lasHeader;
     std::unique_ptr<ZipPoint> m_zipPoint;
     std::unique_ptr<LASunzipper> m_unzipper;
+#ifdef PDAL_HAVE_LASZIP
+    std::unique_ptr<ParallelUnzipper> m_parallelUnzipper;
+#endif
     point_count_t m_index;
+    point_count_t m_start;
     std::istream* m_istream;
+    FileUtils::MapContext m_map;
     VlrList m_vlrs;
     std::vector<ExtraDim> m_extraDims;
+    Accessors m_acc;
+    size_t m_threads;
 
     virtual void processOptions(const Options& options);
     virtual void initialize();
@@ -126,10 +175,14 @@ private:
     virtual void done(PointTableRef table);
     virtual bool eof()
         { return m_index >= getNumPoints(); }
-    void loadPoint(PointView& data, char *buf, size_t bufsize);
-    void loadPointV10(PointView& data, char *buf, size_t bufsize);
-    void loadPointV14(PointView& data, char *buf, size_t bufsize);
+    bool loadPoint(PointView& data, const char *buf, size_t bufsize);
+    bool loadPointV10(PointView& data, const char *buf, size_t bufsize);
+    bool loadPointV14(PointView& data, const char *buf, size_t bufsize);
     void loadExtraDims(LeExtractor& istream, PointView& data, PointId nextId);
+    void decodePoints(PointView& view, const char *buf, point_count_t count);
+    template<int FORMAT>
+    void decodeBlock(PointView& view, const char *buf, point_count_t count);
+    point_count_t readMapped(PointView& view, point_count_t count);
     point_count_t readFileBlock(
             std::vector<char>& buf,
             point_count_t maxPoints);
@@ -137,6 +190,9 @@ private:
     LasReader& operator=(const LasReader&); // not implemented
     LasReader(const LasReader&); // not implemented
     bool m_initialized;
+    bool m_loadAttrs;
+    bool m_loadTime;
+    bool m_loadColor;
 };
 
 } // namespace pdal
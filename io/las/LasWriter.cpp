@@ -60,7 +60,7 @@ CREATE_STATIC_PLUGIN(1, 0, LasWriter, Writer, s_info)
 
 std::string LasWriter::getName() const { return s_info.name; }
 
-LasWriter::LasWriter() : m_ostream(NULL)
+LasWriter::LasWriter() : m_chunkSize(0), m_threads(1), m_ostream(NULL)
 {
     m_xXform.m_scale = .01;
     m_yXform.m_scale = .01;
@@ -74,6 +74,8 @@ Options LasWriter::getDefaultOptions()
 
     options.add("filename", "", "Name of the file for LAS/LAZ output.");
     options.add("compression", false, "Do we LASzip-compress the data?");
+    options.add("chunk_size", 0, "Number of points in each LASzip chunk");
+    options.add("threads", 1, "Number of threads to compress with");
     options.add("format", 3, "Point format to write");
     options.add("major_version", 1, "LAS Major version");
     options.add("minor_version", 2, "LAS Minor version");
@@ -102,6 +104,11 @@ void LasWriter::processOptions(const Options& options)
         "discard_high_return_numbers", false);
     StringList extraDims = options.getValueOrDefault<StringList>("extra_dims");
     m_extraDims = LasUtils::parse(extraDims);
+    m_chunkSize = options.getValueOrDefault<point_count_t>("chunk_size", 0);
+    m_threads = options.getValueOrDefault<size_t>("threads", 1);
+    if (m_threads == 0)
+        throw pdal_error("writers.las: Option 'threads' must be at "
+            "least 1.");
 
 #ifndef PDAL_HAVE_LASZIP
     if (m_lasHeader.compressed())
@@ -481,6 +488,16 @@ void LasWriter::readyCompression()
 #ifdef PDAL_HAVE_LASZIP
     m_zipPoint.reset(new ZipPoint(m_lasHeader.pointFormat(),
         m_lasHeader.pointLen()));
+    LASzip *zip = m_zipPoint->GetZipper();
+    if (m_chunkSize && !zip->set_chunk_size((unsigned)m_chunkSize))
+    {
+        std::ostringstream oss;
+        const char* err = zip->get_error();
+        if (err == NULL)
+            err = "(unknown error)";
+        oss << "Error setting LASzip chunk size: " << std::string(err);
+        throw pdal_error(oss.str());
+    }
     m_zipper.reset(new LASzipper());
     // Note: this will make the VLR count in the header incorrect, but we
     // rewrite that bit in finishOutput() to fix it up.
@@ -495,6 +512,15 @@ void LasWriter::readyCompression()
 void LasWriter::openCompression()
 {
 #ifdef PDAL_HAVE_LASZIP
+    // Chunks are compressed on their own, so they can be compressed
+    // concurrently.
+    if (m_threads > 1)
+    {
+        m_parallelZipper.reset(new ParallelZipper(*m_ostream,
+            m_lasHeader.pointFormat(), m_lasHeader.pointLen(),
+            m_zipPoint->GetZipper()->chunk_size, m_threads));
+        return;
+    }
     if (!m_zipper->open(*m_ostream, m_zipPoint->GetZipper()))
     {
         std::ostringstream oss;
@@ -531,7 +557,9 @@ void LasWriter::writeView(const PointViewPtr view)
         remaining -= filled;
 
 #ifdef PDAL_HAVE_LASZIP
-        if (m_lasHeader.compressed())
+        if (m_parallelZipper)
+            m_parallelZipper->write(buf.data(), filled);
+        else if (m_lasHeader.compressed())
         {
             char *pos = buf.data();
             for (point_count_t i = 0; i < filled; i++)
@@ -764,7 +792,9 @@ void LasWriter::finishOutput()
     // are written or bad things happen since this call expects the
     // stream to be positioned at a particular position.
 #ifdef PDAL_HAVE_LASZIP
-    if (m_lasHeader.compressed())
+    if (m_parallelZipper)
+        m_parallelZipper->close();
+    else if (m_lasHeader.compressed())
         m_zipper->close();
 #endif
 
@@ -798,6 +828,7 @@ void LasWriter::finishOutput()
 #ifdef PDAL_HAVE_LASZIP
     if (m_lasHeader.compressed())
     {
+        m_parallelZipper.reset();
         m_zipper.reset();
         m_zipPoint.reset();
     }
@@ -39,6 +39,7 @@
 #include "LasError.hpp"
 #include "LasHeader.hpp"
 #include "LasUtils.hpp"
+#include "ParallelZipper.hpp"
 #include "SummaryData.hpp"
 #include "ZipPoint.hpp"
 
@@ -83,6 +84,11 @@ private:
     std::unique_ptr<SummaryData> m_summaryData;
     std::unique_ptr<LASzipper> m_zipper;
     std::unique_ptr<ZipPoint> m_zipPoint;
+#ifdef PDAL_HAVE_LASZIP
+    std::unique_ptr<ParallelZipper> m_parallelZipper;
+#endif
+    point_count_t m_chunkSize;
+    size_t m_threads;
     bool m_discardHighReturnNumbers;
     std::map<std::string, std::string> m_headerVals;
     std::vector<VlrOptionInfo> m_optionInfos;
@@ -0,0 +1,246 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ParallelUnzipper.hpp"
+
+#ifdef PDAL_HAVE_LASZIP
+
+#include <pdal/GlobalEnvironment.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include "VariableLengthRecord.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+void throwUnzipError(const std::string& what, const char *err)
+{
+    std::ostringstream oss;
+    if (!err)
+        err = "(unknown error)";
+    oss << what << ": " << err;
+    throw pdal_error(oss.str());
+}
+
+} // unnamed namespace
+
+
+ParallelUnzipper::Decoder::~Decoder()
+{
+    // Close the unzipper before the stream it reads from.
+    m_unzipper.reset();
+    if (m_in)
+        FileUtils::closeFile(m_in);
+}
+
+
+ParallelUnzipper::ParallelUnzipper(const std::string& filename,
+    uint64_t pointOffset, VariableLengthRecord *zipVlr,
+    point_count_t numPoints, size_t pointLen, size_t threads) :
+    m_filename(filename), m_pointOffset(pointOffset), m_zipVlr(zipVlr),
+    m_numPoints(numPoints), m_pointLen(pointLen), m_numChunks(0),
+    m_nextChunk(0), m_start(0), m_end(0), m_pos(0), m_threads(threads),
+    m_pool(GlobalEnvironment::get().threadPool())
+{
+    if (!m_pool)
+    {
+        m_ownPool.reset(new ThreadPool(m_threads));
+        m_pool = m_ownPool.get();
+    }
+    ZipPoint zipPoint(m_zipVlr);
+    m_chunkSize = zipPoint.GetZipper()->chunk_size;
+}
+
+
+ParallelUnzipper::~ParallelUnzipper()
+{
+    drain();
+}
+
+
+bool ParallelUnzipper::chunked(const LASzip& zip)
+{
+    return zip.compressor != LASZIP_COMPRESSOR_POINTWISE &&
+        zip.chunk_size != 0 &&
+        zip.chunk_size != std::numeric_limits<uint32_t>::max();
+}
+
+
+// Only the chunks that hold points from 'start' up to 'end' are decoded.
+void ParallelUnzipper::seek(point_count_t start, point_count_t end)
+{
+    drain();
+    m_end = (std::min)(end, m_numPoints);
+    m_start = (std::min)(start, m_end);
+    m_nextChunk = m_start / m_chunkSize;
+    m_numChunks = (m_end + m_chunkSize - 1) / m_chunkSize;
+    m_current.clear();
+    m_pos = 0;
+    schedule();
+}
+
+
+const char *ParallelUnzipper::next(point_count_t& count)
+{
+    if (m_pos == m_current.size())
+    {
+        if (m_pending.empty())
+        {
+            count = 0;
+            return NULL;
+        }
+        std::future<Buffer> future = std::move(m_pending.front());
+        m_pending.pop_front();
+        schedule();
+        m_pool->wait(future);
+        m_current = future.get();
+        m_pos = 0;
+    }
+
+    count = (std::min)(count,
+        (point_count_t)((m_current.size() - m_pos) / m_pointLen));
+    const char *pos = m_current.data() + m_pos;
+    m_pos += count * m_pointLen;
+    return pos;
+}
+
+
+// Keep two chunks for each thread being decoded ahead of the reader.
+void ParallelUnzipper::schedule()
+{
+    while (m_pending.size() < 2 * m_threads &&
+        m_nextChunk < m_numChunks)
+    {
+        point_count_t chunk = m_nextChunk++;
+        std::shared_ptr<std::packaged_task<Buffer()>> task(
+            new std::packaged_task<Buffer()>(
+                [this, chunk](){ return decode(chunk); }));
+        m_pending.push_back(task->get_future());
+        m_pool->add([task](){ (*task)(); });
+    }
+}
+
+
+// Wait for the chunks being decoded, since they use this object.
+void ParallelUnzipper::drain()
+{
+    for (auto& f : m_pending)
+        m_pool->wait(f);
+    m_pending.clear();
+}
+
+
+ParallelUnzipper::Buffer ParallelUnzipper::decode(point_count_t chunk)
+{
+    point_count_t first = (std::max)(chunk * m_chunkSize, m_start);
+    point_count_t end = (std::min)((chunk + 1) * m_chunkSize, m_end);
+
+    // LASzip only seeks to 32-bit point indexes.
+    if (first > (std::numeric_limits<uint32_t>::max)())
+    {
+        std::ostringstream oss;
+        oss << "Can't seek to compressed point " << first << " of '" <<
+            m_filename << "'.";
+        throw pdal_error(oss.str());
+    }
+    std::unique_ptr<Decoder> decoder = acquire();
+    if (!decoder->m_unzipper->seek((unsigned)first))
+        throwUnzipError("Error seeking in compressed point data",
+            decoder->m_unzipper->get_error());
+
+    Buffer buf((end - first) * m_pointLen);
+    char *pos = buf.data();
+    ZipPoint& zipPoint = *decoder->m_zipPoint;
+    for (point_count_t i = first; i < end; ++i)
+    {
+        if (!decoder->m_unzipper->read(zipPoint.m_lz_point))
+            throwUnzipError("Error reading compressed point data",
+                decoder->m_unzipper->get_error());
+        memcpy(pos, zipPoint.m_lz_point_data.data(), m_pointLen);
+        pos += m_pointLen;
+    }
+    release(std::move(decoder));
+    return buf;
+}
+
+
+// Take an unzipper that isn't in use, or open a new one.  There are never
+// more than one for each chunk being decoded at once.
+std::unique_ptr<ParallelUnzipper::Decoder> ParallelUnzipper::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size())
+        {
+            std::unique_ptr<Decoder> decoder(std::move(m_free.back()));
+            m_free.pop_back();
+            return decoder;
+        }
+    }
+
+    std::unique_ptr<Decoder> decoder(new Decoder);
+    decoder->m_in = FileUtils::openFile(m_filename);
+    if (!decoder->m_in)
+    {
+        std::ostringstream oss;
+        oss << "Unable to open '" << m_filename << "' for decompression.";
+        throw pdal_error(oss.str());
+    }
+    decoder->m_in->seekg(m_pointOffset);
+    decoder->m_zipPoint.reset(new ZipPoint(m_zipVlr));
+    decoder->m_unzipper.reset(new LASunzipper());
+    if (!decoder->m_unzipper->open(*decoder->m_in,
+        decoder->m_zipPoint->GetZipper()))
+        throwUnzipError("Failed to open LASzip stream",
+            decoder->m_unzipper->get_error());
+    return decoder;
+}
+
+
+void ParallelUnzipper::release(std::unique_ptr<Decoder> decoder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.push_back(std::move(decoder));
+}
+
+} // namespace pdal
+
+#endif // PDAL_HAVE_LASZIP
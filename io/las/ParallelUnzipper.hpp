@@ -0,0 +1,137 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/ThreadPool.hpp>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ZipPoint.hpp"
+
+#ifdef PDAL_HAVE_LASZIP
+
+namespace pdal
+{
+
+class VariableLengthRecord;
+
+// Decompresses the points of a LAZ file on several threads.  LASzip
+// compresses points in chunks that can each be decoded on their own, and
+// an unzipper can seek to the start of any chunk using the file's chunk
+// table.  Chunks are decoded concurrently, each by an unzipper that isn't
+// in use, into buffers that are handed out in file order, so the points
+// are the same as those from a single unzipper.  Chunks are decoded on the
+// process-wide thread pool when there is one, with no more than two for
+// each of 'threads' decoded ahead of the reader, so that readers don't add
+// threads of their own to those of the pool.  Otherwise the unzipper runs
+// a pool of 'threads' threads.
+class PDAL_DLL ParallelUnzipper
+{
+public:
+    ParallelUnzipper(const std::string& filename, uint64_t pointOffset,
+        VariableLengthRecord *zipVlr, point_count_t numPoints,
+        size_t pointLen, size_t threads);
+    ~ParallelUnzipper();
+
+    // Whether a file's points are compressed in chunks of a fixed size,
+    // which is what's needed to know where each chunk starts.
+    static bool chunked(const LASzip& zip);
+
+    // Start decompressing at point 'start'.  Points from 'end' on aren't
+    // decompressed.
+    void seek(point_count_t start, point_count_t end);
+    // Records of up to 'count' points, in order, from the chunk being
+    // read.  'count' is set to the number of records returned, which is
+    // zero once every point has been read.
+    const char *next(point_count_t& count);
+
+private:
+    typedef std::vector<char> Buffer;
+
+    struct Decoder
+    {
+        std::istream *m_in;
+        std::unique_ptr<ZipPoint> m_zipPoint;
+        std::unique_ptr<LASunzipper> m_unzipper;
+
+        Decoder() : m_in(NULL)
+        {}
+        ~Decoder();
+    };
+
+    std::string m_filename;
+    uint64_t m_pointOffset;
+    VariableLengthRecord *m_zipVlr;
+    point_count_t m_numPoints;
+    size_t m_pointLen;
+    point_count_t m_chunkSize;
+    point_count_t m_numChunks;
+
+    // Unzippers that aren't decoding a chunk.
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Decoder>> m_free;
+
+    // Chunks being decoded, in order, and the first one not yet started.
+    std::deque<std::future<Buffer>> m_pending;
+    point_count_t m_nextChunk;
+    point_count_t m_start;
+    point_count_t m_end;
+
+    Buffer m_current;
+    size_t m_pos;
+
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_ownPool;
+    ThreadPool *m_pool;
+
+    void schedule();
+    void drain();
+    Buffer decode(point_count_t chunk);
+    std::unique_ptr<Decoder> acquire();
+    void release(std::unique_ptr<Decoder> decoder);
+
+    ParallelUnzipper(const ParallelUnzipper&); // not implemented
+    ParallelUnzipper& operator=(const ParallelUnzipper&); // not implemented
+};
+
+} // namespace pdal
+
+#endif // PDAL_HAVE_LASZIP
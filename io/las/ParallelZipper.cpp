@@ -0,0 +1,311 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ParallelZipper.hpp"
+
+#ifdef PDAL_HAVE_LASZIP
+
+#include <pdal/GlobalEnvironment.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/OStream.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+
+namespace pdal
+{
+
+namespace
+{
+
+void throwZipError(const std::string& what, const char *err)
+{
+    std::ostringstream oss;
+    if (!err)
+        err = "(unknown error)";
+    oss << what << ": " << err;
+    throw pdal_error(oss.str());
+}
+
+
+// Stands in for the output file while LASzip writes a chunk table.  The
+// position only moves when it's told to, once LASzip has written the
+// placeholder for the table's offset, so the size LASzip records for each
+// chunk is the size given for it here.  Once LASzip has filled in the
+// offset and sought back to the end of the point data, the bytes it
+// writes are those of the table, and they're kept.
+class ChunkTableBuf : public std::streambuf
+{
+public:
+    ChunkTableBuf() : m_pos(0), m_end(0), m_started(false), m_away(false),
+        m_keep(false)
+    {}
+
+    void advance(uint64_t bytes)
+    {
+        m_started = true;
+        m_pos += bytes;
+        m_end = m_pos;
+    }
+    const std::string& table() const
+        { return m_table; }
+
+protected:
+    std::streamsize xsputn(const char *s, std::streamsize n)
+    {
+        if (m_keep)
+            m_table.append(s, (size_t)n);
+        else if (!m_started)
+        {
+            m_pos += n;
+            m_end = m_pos;
+        }
+        return n;
+    }
+
+    int_type overflow(int_type c)
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which)
+    {
+        // This is how the position is asked for.
+        if (off == 0 && dir == std::ios_base::cur)
+            return pos_type(m_pos);
+        if (dir == std::ios_base::cur)
+            off += m_pos;
+        else if (dir == std::ios_base::end)
+            off += m_end;
+        return seekpos(pos_type(off), which);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode)
+    {
+        m_pos = (uint64_t)(std::streamoff)pos;
+        if (m_pos != m_end)
+            m_away = true;
+        else if (m_away)
+            m_keep = true;
+        return pos;
+    }
+
+private:
+    uint64_t m_pos;
+    uint64_t m_end;
+    bool m_started;
+    bool m_away;
+    bool m_keep;
+    std::string m_table;
+};
+
+} // unnamed namespace
+
+
+ParallelZipper::ParallelZipper(std::ostream& out, uint8_t format,
+    uint16_t pointLen, point_count_t chunkSize, size_t threads) :
+    m_out(out), m_format(format), m_pointLen(pointLen),
+    m_chunkSize(chunkSize), m_threads(threads),
+    m_pool(GlobalEnvironment::get().threadPool())
+{
+    if (!m_pool)
+    {
+        m_ownPool.reset(new ThreadPool(m_threads));
+        m_pool = m_ownPool.get();
+    }
+
+    // LASzip starts the point data with the offset of the chunk table,
+    // which is filled in once the table's been written.
+    m_tableOffsetPos = m_out.tellp();
+    OLeStream ostream(&m_out);
+    ostream << (int64_t)-1;
+    m_points.reserve(m_chunkSize * m_pointLen);
+}
+
+
+ParallelZipper::~ParallelZipper()
+{
+    drain();
+}
+
+
+void ParallelZipper::write(const char *buf, point_count_t count)
+{
+    size_t chunkLen = m_chunkSize * m_pointLen;
+    const char *end = buf + count * m_pointLen;
+    while (buf < end)
+    {
+        size_t len = (std::min)((size_t)(end - buf),
+            chunkLen - m_points.size());
+        m_points.insert(m_points.end(), buf, buf + len);
+        buf += len;
+        if (m_points.size() == chunkLen)
+            submit();
+    }
+}
+
+
+void ParallelZipper::close()
+{
+    if (m_points.size())
+        submit();
+    while (m_pending.size())
+        writeChunk();
+
+    std::string table = chunkTable();
+    std::streampos tablePos = m_out.tellp();
+    m_out.write(table.data(), table.size());
+    std::streampos end = m_out.tellp();
+
+    OLeStream ostream(&m_out);
+    ostream.seek(m_tableOffsetPos);
+    ostream << (int64_t)tablePos;
+    ostream.seek(end);
+}
+
+
+// Hand the filled chunk to the pool, writing the oldest chunks once there
+// are two for each thread being compressed.
+void ParallelZipper::submit()
+{
+    std::shared_ptr<Buffer> points(new Buffer);
+    points->swap(m_points);
+    m_points.reserve(m_chunkSize * m_pointLen);
+
+    std::shared_ptr<std::packaged_task<Buffer()>> task(
+        new std::packaged_task<Buffer()>(
+            [this, points](){ return compress(*points); }));
+    m_pending.push_back(task->get_future());
+    m_pool->add([task](){ (*task)(); });
+
+    while (m_pending.size() > 2 * m_threads)
+        writeChunk();
+}
+
+
+void ParallelZipper::writeChunk()
+{
+    std::future<Buffer> future = std::move(m_pending.front());
+    m_pending.pop_front();
+    m_pool->wait(future);
+    Buffer chunk = future.get();
+    m_out.write(chunk.data(), chunk.size());
+    m_chunkBytes.push_back(chunk.size());
+}
+
+
+// Wait for the chunks being compressed, since they use this object.
+void ParallelZipper::drain()
+{
+    for (auto& f : m_pending)
+        m_pool->wait(f);
+    m_pending.clear();
+}
+
+
+// Compress one chunk as a stream of its own.  The stream holds the offset
+// of its chunk table, the chunk, and the table.  Only the chunk is kept.
+ParallelZipper::Buffer ParallelZipper::compress(const Buffer& points)
+{
+    ZipPoint zipPoint(m_format, m_pointLen);
+    zipPoint.GetZipper()->set_chunk_size((unsigned)m_chunkSize);
+
+    std::ostringstream out(std::ios::out | std::ios::binary);
+    LASzipper zipper;
+    if (!zipper.open(out, zipPoint.GetZipper()))
+        throwZipError("Error opening LASzipper", zipper.get_error());
+    for (const char *pos = points.data(); pos < points.data() + points.size();
+        pos += m_pointLen)
+    {
+        memcpy(zipPoint.m_lz_point_data.data(), pos, m_pointLen);
+        if (!zipper.write(zipPoint.m_lz_point))
+            throwZipError("Error writing point", zipper.get_error());
+    }
+    if (!zipper.close())
+        throwZipError("Error closing LASzipper", zipper.get_error());
+
+    std::string s = out.str();
+    int64_t tablePos;
+    LeExtractor in(s.data(), s.size());
+    in >> tablePos;
+    if (tablePos < (int64_t)sizeof(tablePos) || tablePos > (int64_t)s.size())
+        throw pdal_error("Invalid chunk table offset in compressed chunk.");
+    return Buffer(s.data() + sizeof(tablePos), s.data() + tablePos);
+}
+
+
+// The entries of a chunk table are themselves compressed.  Rather than do
+// that here, a zipper writes a table with one chunk for each chunk that was
+// written by compressing a single point per chunk, while the stream it
+// writes to reports the position that each of those chunks ends at in the
+// file.  Only the sizes of chunks are stored in the table, not their
+// number of points, so it's the table for the file.
+std::string ParallelZipper::chunkTable()
+{
+    ZipPoint zipPoint(m_format, m_pointLen);
+    zipPoint.GetZipper()->set_chunk_size(1);
+    memset(zipPoint.m_lz_point_data.data(), 0,
+        zipPoint.m_lz_point_data.size());
+
+    ChunkTableBuf buf;
+    std::ostream out(&buf);
+    LASzipper zipper;
+    if (!zipper.open(out, zipPoint.GetZipper()))
+        throwZipError("Error opening LASzipper", zipper.get_error());
+    buf.advance(0);
+    for (size_t i = 0; i < m_chunkBytes.size(); ++i)
+    {
+        // A chunk ends when the next point is written.
+        if (i)
+            buf.advance(m_chunkBytes[i - 1]);
+        if (!zipper.write(zipPoint.m_lz_point))
+            throwZipError("Error writing chunk table", zipper.get_error());
+    }
+    if (m_chunkBytes.size())
+        buf.advance(m_chunkBytes.back());
+    if (!zipper.close())
+        throwZipError("Error writing chunk table", zipper.get_error());
+    return buf.table();
+}
+
+} // namespace pdal
+
+#endif // PDAL_HAVE_LASZIP
@@ -0,0 +1,106 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/ThreadPool.hpp>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "ZipPoint.hpp"
+
+#ifdef PDAL_HAVE_LASZIP
+
+namespace pdal
+{
+
+// Compresses the points of a LAZ file on several threads.  LASzip
+// compresses points in chunks that don't depend on each other, so each
+// chunk is compressed by its own zipper and the chunks are written to the
+// file in order, followed by a chunk table that gives the size of each.
+// The result is the same as that of a single zipper.  Chunks are compressed
+// on the process-wide thread pool when there is one, with no more than two
+// for each of 'threads' waiting to be written, so that writers don't add
+// threads of their own to those of the pool.  Otherwise the zipper runs a
+// pool of 'threads' threads.
+class PDAL_DLL ParallelZipper
+{
+public:
+    ParallelZipper(std::ostream& out, uint8_t format, uint16_t pointLen,
+        point_count_t chunkSize, size_t threads);
+    ~ParallelZipper();
+
+    // Compress 'count' point records.
+    void write(const char *buf, point_count_t count);
+    // Write the remaining chunks and the chunk table.  The stream is left
+    // positioned after the table.
+    void close();
+
+private:
+    typedef std::vector<char> Buffer;
+
+    std::ostream& m_out;
+    uint8_t m_format;
+    uint16_t m_pointLen;
+    point_count_t m_chunkSize;
+    std::streampos m_tableOffsetPos;
+
+    // Points of the chunk being filled.
+    Buffer m_points;
+    // Chunks being compressed, in order.
+    std::deque<std::future<Buffer>> m_pending;
+    std::vector<uint64_t> m_chunkBytes;
+
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_ownPool;
+    ThreadPool *m_pool;
+
+    void submit();
+    void writeChunk();
+    void drain();
+    Buffer compress(const Buffer& points);
+    std::string chunkTable();
+
+    ParallelZipper(const ParallelZipper&); // not implemented
+    ParallelZipper& operator=(const ParallelZipper&); // not implemented
+};
+
+} // namespace pdal
+
+#endif // PDAL_HAVE_LASZIP
@@ -85,6 +85,8 @@ public:
         { return m_size; }
     point_count_t getNumPoints() const
         { return m_numPoints; }
+    virtual point_count_t numPoints() const
+        { return m_numPoints; }
     bool eof()
         { return m_index >= m_numPoints; }
 
@@ -34,6 +34,8 @@
 
 #include "SbetReader.hpp"
 
+#include <algorithm>
+
 namespace pdal
 {
 
@@ -71,6 +73,13 @@ void SbetReader::ready(PointTableRef)
 }
 
 
+bool SbetReader::acceptsPredicate(const DimPredicate& pred) const
+{
+    Dimension::IdList dims = getDefaultDimensions();
+    return std::find(dims.begin(), dims.end(), pred.m_id) != dims.end();
+}
+
+
 point_count_t SbetReader::read(PointViewPtr view, point_count_t count)
 {
     PointId nextId = view->size();
@@ -78,22 +87,34 @@ point_count_t SbetReader::read(PointViewPtr view, point_count_t count)
     point_count_t numRead = 0;
     seek(idx);
     Dimension::IdList dims = getDefaultDimensions();
+    std::vector<double> vals(dims.size());
+
+    // Position of the value of each pushed predicate's dimension.
+    const DimPredicateList& preds = pushedPredicates();
+    std::vector<size_t> predPos;
+    for (const DimPredicate& p : preds)
+        predPos.push_back(std::distance(dims.begin(),
+            std::find(dims.begin(), dims.end(), p.m_id)));
+
     while (numRead < count && idx < m_numPts)
     {
-        for (auto di = dims.begin(); di != dims.end(); ++di)
-        {
-            double d;
+        for (double& d : vals)
             *m_stream >> d;
-            Dimension::Id::Enum dim = *di;
-            view->setField(dim, nextId, d);
-        }
+        idx++;
+        numRead++;
+
+        bool keep = true;
+        for (size_t i = 0; keep && i < preds.size(); ++i)
+            keep = preds[i].passes(vals[predPos[i]]);
+        if (!keep)
+            continue;
+
+        for (size_t i = 0; i < dims.size(); ++i)
+            view->setField(dims[i], nextId, vals[i]);
 
         if (m_cb)
             m_cb(*view, nextId);
-
-        idx++;
         nextId++;
-        numRead++;
     }
     m_index = idx;
     return numRead;
@@ -49,7 +49,7 @@ namespace pdal
 class PDAL_DLL SbetReader : public pdal::Reader
 {
 public:
-    SbetReader() : Reader()
+    SbetReader() : Reader(), m_numPts(0)
         {}
 
     static void * create();
@@ -59,6 +59,11 @@ public:
     Options getDefaultOptions();
     static Dimension::IdList getDefaultDimensions()
         { return fileDimensions(); }
+    virtual point_count_t numPoints() const
+        { return m_numPts; }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool acceptsPredicate(const DimPredicate& pred) const;
 
 private:
     std::unique_ptr<ILeStream> m_stream;
@@ -108,6 +108,8 @@ public:
 
     point_count_t getNumPoints() const
         { return m_header->PntCnt; }
+    virtual point_count_t numPoints() const
+        { return getNumPoints(); }
 
     const TerraSolidHeader& getHeader() const { return *m_header; }
 
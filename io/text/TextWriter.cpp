@@ -87,6 +87,23 @@ Options TextWriter::getDefaultOptions()
 }
 
 
+bool TextWriter::usedDims(StringList& dims) const
+{
+    const Options& ops = getOptions();
+    std::string order = ops.getValueOrDefault<std::string>("order", "");
+    if (order.empty() || ops.getValueOrDefault<bool>("keep_unspecified", true))
+        return false;
+
+    boost::erase_all(order, " ");
+    boost::split(dims, order, boost::is_any_of(","));
+    // GeoJSON output always uses X, Y and Z for the geometry.
+    dims.push_back("X");
+    dims.push_back("Y");
+    dims.push_back("Z");
+    return true;
+}
+
+
 void TextWriter::processOptions(const Options& ops)
 {
     m_filename = ops.getValueOrThrow<std::string>("filename");
@@ -60,8 +60,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const;
 
     Options getDefaultOptions();
+    virtual bool streamable() const
+        { return m_outputType == "CSV"; }
 
 private:
     virtual void processOptions(const Options&);
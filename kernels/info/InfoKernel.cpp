@@ -63,6 +63,8 @@ InfoKernel::InfoKernel()
     , m_showSchema(false)
     , m_showAll(false)
     , m_showMetadata(false)
+    , m_showMemory(false)
+    , m_memoryBudget(0)
     , m_boundary(false)
     , m_showSummary(false)
     , m_needPoints(false)
@@ -167,6 +169,14 @@ void InfoKernel::addSwitches()
         ("metadata",
          po::value<bool>(&m_showMetadata)->zero_tokens()->implicit_value(true),
         "dump file metadata info")
+        ("memory",
+         po::value<bool>(&m_showMemory)->zero_tokens()->implicit_value(true),
+        "dump current and peak memory used for points, views, indexes and "
+        "stage buffers")
+        ("memory-budget",
+         po::value<uint64_t>(&m_memoryBudget)->default_value(0),
+         "Fail as soon as the memory used for points, views, indexes and "
+         "stage buffers would exceed this many megabytes (0 = no limit)")
         ;
 
     po::options_description* hidden =
@@ -302,6 +312,7 @@ void InfoKernel::setup(const std::string& filename)
     m_manager = std::unique_ptr<PipelineManager>(
         KernelSupport::makePipeline(filename));
     m_reader = m_manager->getStage();
+    m_manager->pointTable().memory()->setBudget(m_memoryBudget * 1024 * 1024);
     Stage *stage = m_reader;
 
     if (m_dimensions.size())
@@ -347,6 +358,8 @@ MetadataNode InfoKernel::run(const std::string& filename)
         else
             m_manager->prepare();
         dump(root);
+        if (m_showMemory)
+            m_manager->pointTable().memory()->write(root);
     }
     root.add("pdal_version", pdal::GetFullVersionString());
     return root;
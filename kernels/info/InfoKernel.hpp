@@ -89,6 +89,8 @@ private:
     bool m_showSchema;
     bool m_showAll;
     bool m_showMetadata;
+    bool m_showMemory;
+    uint64_t m_memoryBudget;
     bool m_boundary;
     pdal::Options m_options;
     std::string m_pointIndexes;
@@ -40,6 +40,7 @@
 
 #include <boost/program_options.hpp>
 
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/PDALUtils.hpp>
 
 namespace pdal
@@ -54,7 +55,9 @@ CREATE_STATIC_PLUGIN(1, 0, PipelineKernel, Kernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_threads(1), m_branches(0), m_table("row"), m_profile(false),
+    m_memory(false), m_memoryBudget(0), m_compact(0)
 {}
 
 
@@ -65,6 +68,8 @@ void PipelineKernel::validateSwitches()
 
     if (m_inputFile.empty())
         throw app_usage_error("input file name required");
+    if (m_table != "row" && m_table != "column" && m_table != "mapped")
+        throw app_usage_error("--table must be 'row', 'column' or 'mapped'");
 }
 
 
@@ -86,6 +91,38 @@ void PipelineKernel::addSwitches()
             "Name of file or FIFO to which stages should write progress "
             "information.  The file/FIFO must exist.  PDAL will not create "
             "the progress file.")
+        ("threads", po::value<uint32_t>(&m_threads)->default_value(1),
+            "Number of threads used to run stages on separate point views "
+            "at the same time (0 = one per core).  Overrides the pipeline's "
+            "'threads' attribute.")
+        ("branches", po::value<uint32_t>(&m_branches)->default_value(0),
+            "Most input branches of a stage (such as the readers of a "
+            "merge) that execute at once, each with its own point table "
+            "(0 = one per thread).  Overrides the pipeline's 'branches' "
+            "attribute.")
+        ("table", po::value<std::string>(&m_table)->default_value("row"),
+            "Point storage layout: 'row' (points interleaved), 'column' "
+            "(one array per dimension) or 'mapped' (points interleaved in a "
+            "memory-mapped scratch file)")
+        ("tmpdir", po::value<std::string>(&m_tmpDir),
+            "Directory for the scratch file of a 'mapped' point table "
+            "(default: system temporary directory)")
+        ("profile",
+            po::value<bool>(&m_profile)->zero_tokens()->implicit_value(true),
+            "Write the time, CPU use, point counts and table memory of "
+            "each stage to standard error as JSON")
+        ("memory",
+            po::value<bool>(&m_memory)->zero_tokens()->implicit_value(true),
+            "Write the current and peak memory used for points, views, "
+            "indexes and stage buffers to standard error as JSON")
+        ("memory-budget",
+            po::value<uint64_t>(&m_memoryBudget)->default_value(0),
+            "Fail as soon as the memory used for points, views, indexes "
+            "and stage buffers would exceed this many megabytes "
+            "(0 = no limit)")
+        ("compact", po::value<double>(&m_compact)->default_value(0),
+            "Compact point storage after a stage leaves fewer than this "
+            "fraction of the table's points in use (0 = never)")
         ;
 
     addSwitchSet(file_options);
@@ -109,7 +146,16 @@ int PipelineKernel::execute()
     if (m_progressFile.size())
         m_progressFd = Utils::openProgress(m_progressFile);
 
-    pdal::PipelineManager manager(m_progressFd);
+    std::unique_ptr<BasePointTable> table;
+    if (m_table == "column")
+        table.reset(new ColumnPointTable());
+    else if (m_table == "mapped")
+        table.reset(new MappedPointTable(m_tmpDir));
+    else
+        table.reset(new PointTable());
+    table->memory()->setBudget(m_memoryBudget * 1024 * 1024);
+    table->setAutoCompact(m_compact);
+    pdal::PipelineManager manager(*table, m_progressFd);
 
     pdal::PipelineReader reader(manager, isDebug(), getVerboseLevel());
     bool isWriter = reader.readPipeline(m_inputFile);
@@ -117,8 +163,18 @@ int PipelineKernel::execute()
         throw app_runtime_error("Pipeline file does not contain a writer. "
             "Use 'pdal info' to read the data.");
 
+    if (argumentExists("threads"))
+        GlobalEnvironment::get().setThreads(m_threads);
+    if (argumentExists("branches"))
+        GlobalEnvironment::get().setMaxBranches(m_branches);
+
+    GlobalEnvironment::get().setProfiling(m_profile);
+
     applyExtraStageOptionsRecursive(manager.getStage());
     manager.execute();
+    if (m_profile || m_memory)
+        writeReport(manager.getStage(),
+            m_memory ? table->memory() : MemoryTrackerPtr());
     if (m_pipelineFile.size() > 0)
     {
         pdal::PipelineWriter writer(manager);
@@ -65,6 +65,14 @@ private:
     std::string m_PointCloudSchemaOutput;
     std::string m_progressFile;
     int m_progressFd;
+    uint32_t m_threads;
+    uint32_t m_branches;
+    std::string m_table;
+    std::string m_tmpDir;
+    bool m_profile;
+    bool m_memory;
+    uint64_t m_memoryBudget;
+    double m_compact;
 };
 
 } // pdal
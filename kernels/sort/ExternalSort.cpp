@@ -0,0 +1,362 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ExternalSort.hpp"
+
+#include <pdal/util/FileUtils.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+namespace pdal
+{
+
+SortRunList::~SortRunList()
+{
+    for (auto& r : m_runs)
+        FileUtils::deleteFile(r.m_filename);
+}
+
+
+std::string SortRunList::tempFilename() const
+{
+    namespace fs = boost::filesystem;
+    fs::path dir(m_tmpDir);
+    if (dir.empty())
+        dir = fs::temp_directory_path();
+    return (dir / fs::unique_path("pdal_sort_%%%%-%%%%-%%%%.run")).string();
+}
+
+
+void SortRunWriter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+    m_runs.m_dimTypes = layout->dimTypes();
+    m_runs.m_dimNames.clear();
+    for (auto& d : m_runs.m_dimTypes)
+        m_runs.m_dimNames.push_back(layout->dimName(d.m_id));
+    m_runs.m_numKeys = m_keys.size();
+}
+
+
+void SortRunWriter::write(const PointViewPtr view)
+{
+    if (view->empty())
+        return;
+
+    PointSorter sorter(m_keys, m_pool);
+    sorter.sort(*view);
+    std::vector<std::vector<uint64_t>> keys;
+    for (auto& k : m_keys)
+        keys.push_back(PointSorter::keyValues(*view, k));
+
+    SortRunList::Run run;
+    run.m_filename = m_runs.tempFilename();
+    run.m_count = view->size();
+    // Add the run before writing so that the file is removed on failure.
+    m_runs.m_runs.push_back(run);
+
+    std::ofstream out(run.m_filename, std::ios::out | std::ios::binary);
+    if (!out)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Can't create temporary file '" <<
+            run.m_filename << "'.";
+        throw pdal_error(oss.str());
+    }
+
+    size_t keySize = keys.size() * sizeof(uint64_t);
+    size_t recordSize = keySize + view->pointSize();
+    const size_t bufRecords = (std::max)((size_t)1,
+        (size_t)(1 << 20) / recordSize);
+    std::vector<char> buf(bufRecords * recordSize);
+    for (PointId idx = 0; idx < view->size();)
+    {
+        char *pos = buf.data();
+        size_t cnt = 0;
+        for (; cnt < bufRecords && idx < view->size(); ++cnt, ++idx)
+        {
+            for (auto& k : keys)
+            {
+                std::memcpy(pos, &k[idx], sizeof(uint64_t));
+                pos += sizeof(uint64_t);
+            }
+            view->getPackedPoint(m_runs.m_dimTypes, idx, pos);
+            pos += view->pointSize();
+        }
+        out.write(buf.data(), cnt * recordSize);
+    }
+    out.close();
+    if (!out)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Error writing temporary file '" <<
+            run.m_filename << "'.";
+        throw pdal_error(oss.str());
+    }
+}
+
+
+point_count_t SortRunReader::numPoints() const
+{
+    point_count_t count = 0;
+    for (auto& r : m_runs.m_runs)
+        count += r.m_count;
+    return count;
+}
+
+
+void SortRunReader::addDimensions(PointLayoutPtr layout)
+{
+    m_dims.clear();
+    for (size_t i = 0; i < m_runs.m_dimNames.size(); ++i)
+    {
+        Dimension::Type::Enum type = m_runs.m_dimTypes[i].m_type;
+        m_dims.push_back(DimType(
+            layout->registerOrAssignDim(m_runs.m_dimNames[i], type), type));
+    }
+}
+
+
+void SortRunReader::ready(PointTableRef /*table*/)
+{
+    m_recordSize = m_runs.m_numKeys * sizeof(uint64_t);
+    for (auto& d : m_dims)
+        m_recordSize += Dimension::size(d.m_type);
+
+    while (m_runs.m_runs.size() > m_maxFanIn)
+        mergePass();
+    m_merger.reset(new RunMerger(m_runs.m_runs, m_runs.m_numKeys,
+        m_recordSize, m_bufferBytes));
+}
+
+
+// Merge each group of 'm_maxFanIn' runs into a run of its own.  Groups are
+// of adjacent runs and the merged runs stay in the same order, so that the
+// sort stays stable.
+void SortRunReader::mergePass()
+{
+    size_t numRuns = m_runs.m_runs.size();
+    log()->get(LogLevel::Debug) << getName() << ": Merging " << numRuns <<
+        " runs in groups of " << m_maxFanIn << "." << std::endl;
+
+    const size_t bufRecords = (std::max)((size_t)1,
+        (size_t)(1 << 20) / m_recordSize);
+    std::vector<char> buf(bufRecords * m_recordSize);
+    for (size_t first = 0; first < numRuns; first += m_maxFanIn)
+    {
+        std::vector<SortRunList::Run> group(
+            m_runs.m_runs.begin() + first,
+            m_runs.m_runs.begin() + (std::min)(first + m_maxFanIn, numRuns));
+
+        // Add the run before writing so that the file is removed on
+        // failure.
+        SortRunList::Run run;
+        run.m_filename = m_runs.tempFilename();
+        run.m_count = 0;
+        for (auto& r : group)
+            run.m_count += r.m_count;
+        m_runs.m_runs.push_back(run);
+
+        std::ofstream out(run.m_filename, std::ios::out | std::ios::binary);
+        if (!out)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Can't create temporary file '" <<
+                run.m_filename << "'.";
+            throw pdal_error(oss.str());
+        }
+
+        {
+            RunMerger merger(group, m_runs.m_numKeys, m_recordSize,
+                m_bufferBytes);
+            const char *rec = merger.next();
+            while (rec)
+            {
+                size_t cnt = 0;
+                for (; cnt < bufRecords && rec; ++cnt, rec = merger.next())
+                    std::memcpy(buf.data() + cnt * m_recordSize, rec,
+                        m_recordSize);
+                out.write(buf.data(), cnt * m_recordSize);
+            }
+        }
+        out.close();
+        if (!out)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Error writing temporary file '" <<
+                run.m_filename << "'.";
+            throw pdal_error(oss.str());
+        }
+        for (auto& r : group)
+            FileUtils::deleteFile(r.m_filename);
+    }
+    m_runs.m_runs.erase(m_runs.m_runs.begin(),
+        m_runs.m_runs.begin() + numRuns);
+}
+
+
+point_count_t SortRunReader::read(PointViewPtr view, point_count_t count)
+{
+    size_t keySize = m_runs.m_numKeys * sizeof(uint64_t);
+
+    PointId idx = view->size();
+    point_count_t numRead = 0;
+    const char *rec;
+    while (numRead < count && (rec = m_merger->next()))
+    {
+        view->setPackedPoint(m_dims, idx++, rec + keySize);
+        numRead++;
+    }
+    return numRead;
+}
+
+
+void SortRunReader::done(PointTableRef /*table*/)
+{
+    m_merger.reset();
+}
+
+
+// Share the buffer space among the runs, but hold at least a minimum
+// amount of each (or all of the space, if that's less) so that reads
+// don't get too small.
+RunMerger::RunMerger(const std::vector<SortRunList::Run>& runs,
+    size_t numKeys, size_t recordSize, size_t bufferBytes) :
+    m_numKeys(numKeys), m_recordSize(recordSize), m_last(runs.size())
+{
+    const size_t MinRunBuffer = 64 * 1024;
+
+    size_t numRuns = (std::max)((size_t)1, runs.size());
+    size_t runBytes = (std::max)(bufferBytes / numRuns,
+        (std::min)(bufferBytes, MinRunBuffer));
+    size_t records = (std::max)((size_t)1, runBytes / m_recordSize);
+
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const SortRunList::Run& run = runs[i];
+        Source src;
+        src.m_filename = run.m_filename;
+        src.m_in.reset(new std::ifstream(run.m_filename,
+            std::ios::in | std::ios::binary));
+        if (!*src.m_in)
+        {
+            std::ostringstream oss;
+            oss << "readers.sortrun: Can't open temporary file '" <<
+                run.m_filename << "'.";
+            throw pdal_error(oss.str());
+        }
+        src.m_buf.resize((size_t)(std::min)((point_count_t)records,
+            (std::max)(run.m_count, (point_count_t)1)) * m_recordSize);
+        src.m_left = run.m_count;
+        src.m_pos = 0;
+        src.m_end = 0;
+        m_sources.push_back(std::move(src));
+        if (fill(m_sources.back()))
+            m_heap.push_back(i);
+    }
+    auto cmp = [this](size_t r1, size_t r2){ return after(r1, r2); };
+    std::make_heap(m_heap.begin(), m_heap.end(), cmp);
+}
+
+
+const char *RunMerger::next()
+{
+    auto cmp = [this](size_t r1, size_t r2){ return after(r1, r2); };
+
+    // Move past the record returned last time, now that it's been used.
+    if (m_last < m_sources.size())
+    {
+        Source& src = m_sources[m_last];
+        src.m_pos += m_recordSize;
+        if (src.m_pos < src.m_end || fill(src))
+            std::push_heap(m_heap.begin(), m_heap.end(), cmp);
+        else
+            m_heap.pop_back();
+        m_last = m_sources.size();
+    }
+    if (m_heap.empty())
+        return NULL;
+
+    std::pop_heap(m_heap.begin(), m_heap.end(), cmp);
+    m_last = m_heap.back();
+    Source& src = m_sources[m_last];
+    return src.m_buf.data() + src.m_pos;
+}
+
+
+// Read the next records of a run into its buffer.  Returns false if the
+// run is used up.
+bool RunMerger::fill(Source& src)
+{
+    if (src.m_left == 0)
+        return false;
+    point_count_t cnt = (std::min)(src.m_left,
+        (point_count_t)(src.m_buf.size() / m_recordSize));
+    src.m_in->read(src.m_buf.data(), cnt * m_recordSize);
+    if (!*src.m_in)
+    {
+        std::ostringstream oss;
+        oss << "readers.sortrun: Error reading temporary file '" <<
+            src.m_filename << "'.";
+        throw pdal_error(oss.str());
+    }
+    src.m_left -= cnt;
+    src.m_pos = 0;
+    src.m_end = cnt * m_recordSize;
+    return true;
+}
+
+
+// Whether the current record of 'run1' goes after that of 'run2'.  Records
+// with equal keys come from the earlier run first, which keeps the sort
+// stable.
+bool RunMerger::after(size_t run1, size_t run2) const
+{
+    const char *p1 = m_sources[run1].m_buf.data() + m_sources[run1].m_pos;
+    const char *p2 = m_sources[run2].m_buf.data() + m_sources[run2].m_pos;
+    for (size_t k = 0; k < m_numKeys; ++k)
+    {
+        uint64_t k1, k2;
+        std::memcpy(&k1, p1 + k * sizeof(uint64_t), sizeof(uint64_t));
+        std::memcpy(&k2, p2 + k * sizeof(uint64_t), sizeof(uint64_t));
+        if (k1 != k2)
+            return k1 > k2;
+    }
+    return run1 > run2;
+}
+
+} // namespace pdal
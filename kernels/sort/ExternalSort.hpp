@@ -0,0 +1,178 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/PointSort.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Writer.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+
+class ThreadPool;
+
+// Temporary files holding runs of sorted points.  Each record is the
+// point's sort key values (see PointSorter::keyValues()) followed by its
+// dimensions, packed.  The files are removed when the list is destroyed.
+struct SortRunList
+{
+    struct Run
+    {
+        std::string m_filename;
+        point_count_t m_count;
+    };
+
+    SortRunList(const std::string& tmpDir) : m_tmpDir(tmpDir)
+    {}
+    ~SortRunList();
+
+    // Name for a new temporary file in the temporary directory.
+    std::string tempFilename() const;
+
+    std::string m_tmpDir;
+    std::vector<Run> m_runs;
+    // Names and types of the dimensions in each record.
+    std::vector<std::string> m_dimNames;
+    DimTypeList m_dimTypes;
+    size_t m_numKeys;
+};
+
+
+// Sorts each chunk of points it's given in streaming mode and writes it to
+// a temporary file as a run.
+class PDAL_DLL SortRunWriter : public Writer
+{
+public:
+    SortRunWriter(const SortKeyList& keys, SortRunList& runs,
+        ThreadPool *pool) : m_keys(keys), m_runs(runs), m_pool(pool)
+    {}
+
+    // Keys can be set once the writer is prepared, when dimension names
+    // can be resolved in the layout.
+    void setKeys(const SortKeyList& keys)
+        { m_keys = keys; }
+
+    std::string getName() const
+        { return "writers.sortrun"; }
+    virtual bool streamable() const
+        { return true; }
+
+private:
+    SortKeyList m_keys;
+    SortRunList& m_runs;
+    ThreadPool *m_pool;
+
+    virtual void ready(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+};
+
+
+// Merges sorted runs, a buffer's worth of records of each at a time.
+class RunMerger
+{
+public:
+    RunMerger(const std::vector<SortRunList::Run>& runs, size_t numKeys,
+        size_t recordSize, size_t bufferBytes);
+
+    // The next record in sorted order, or NULL once every run is used up.
+    // The record is valid until the next call.
+    const char *next();
+
+private:
+    struct Source
+    {
+        std::string m_filename;
+        std::unique_ptr<std::ifstream> m_in;
+        std::vector<char> m_buf;
+        point_count_t m_left;      // Records not yet read from the file.
+        size_t m_pos;              // Offset of the current record.
+        size_t m_end;              // End of the records in the buffer.
+    };
+
+    size_t m_numKeys;
+    size_t m_recordSize;
+    std::vector<Source> m_sources;
+    // Runs with records left, as a heap on their current record.
+    std::vector<size_t> m_heap;
+    // Run of the record last returned, advanced on the next call.
+    size_t m_last;
+
+    bool fill(Source& src);
+    bool after(size_t run1, size_t run2) const;
+};
+
+
+// Merges the runs written by a SortRunWriter and provides the points in
+// sorted order.  At most 'maxFanIn' runs are merged at once.  When there
+// are more, groups of runs are merged into longer runs first, as many
+// times as needed.
+class PDAL_DLL SortRunReader : public Reader
+{
+public:
+    static const size_t DefaultFanIn = 128;
+
+    SortRunReader(SortRunList& runs, size_t bufferBytes,
+            size_t maxFanIn = DefaultFanIn) : m_runs(runs),
+        m_bufferBytes(bufferBytes), m_maxFanIn((std::max)((size_t)2, maxFanIn))
+    {}
+
+    std::string getName() const
+        { return "readers.sortrun"; }
+    virtual bool streamable() const
+        { return true; }
+    virtual point_count_t numPoints() const;
+
+private:
+    SortRunList& m_runs;
+    size_t m_bufferBytes;
+    size_t m_maxFanIn;
+    size_t m_recordSize;
+    DimTypeList m_dims;
+    std::unique_ptr<RunMerger> m_merger;
+
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual void done(PointTableRef table);
+    void mergePass();
+};
+
+} // namespace pdal
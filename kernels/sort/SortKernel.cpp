@@ -33,10 +33,13 @@
 ****************************************************************************/
 
 #include "SortKernel.hpp"
+#include "ExternalSort.hpp"
 
 #include <pdal/BufferReader.hpp>
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/KernelSupport.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/Utils.hpp>
 
 #include <boost/program_options.hpp>
 
@@ -56,7 +59,8 @@ std::string SortKernel::getName() const
 }
 
 
-SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false)
+SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false),
+    m_curve("morton"), m_runMemory(0)
 {}
 
 
@@ -66,6 +70,19 @@ void SortKernel::validateSwitches()
         throw app_usage_error("--input/-i required");
     if (m_outputFile == "")
         throw app_usage_error("--output/-o required");
+    m_curve = Utils::tolower(m_curve);
+    if (m_curve != "morton" && m_curve != "hilbert" && m_curve != "morton3d")
+        throw app_usage_error("--curve must be 'morton', 'hilbert' or "
+            "'morton3d'");
+    if (m_orders.size() > 1 && m_orders.size() != m_dims.size())
+        throw app_usage_error("--order must be given once or once for "
+            "each dimension");
+    for (auto& o : m_orders)
+    {
+        o = Utils::toupper(o);
+        if (o != "ASC" && o != "DESC")
+            throw app_usage_error("--order must be 'ASC' or 'DESC'");
+    }
 }
 
 
@@ -85,6 +102,21 @@ void SortKernel::addSwitches()
     ("metadata,m",
      po::value< bool >(&m_bForwardMetadata)->implicit_value(true),
      "Forward metadata (VLRs, header entries, etc) from previous stages")
+    ("dimension,d", po::value<StringList>(&m_dims)->multitoken(),
+     "Dimensions to sort on, most significant first.  Points are put in "
+     "order along a curve if none are given")
+    ("order", po::value<StringList>(&m_orders)->multitoken(),
+     "ASC or DESC, once for all dimensions or once for each [ASC]")
+    ("curve", po::value<std::string>(&m_curve)->default_value("morton"),
+     "Space-filling curve to order points along when no dimensions are "
+     "given: morton, hilbert or morton3d")
+    ("run-memory", po::value<uint64_t>(&m_runMemory)->default_value(0),
+     "Sort input larger than memory: sort runs of points that fit in this "
+     "many megabytes, write them to temporary files and merge them "
+     "(0 = sort in memory)")
+    ("tmpdir", po::value<std::string>(&m_tmpDir),
+     "Directory for the temporary files of --run-memory "
+     "[system temporary directory]")
     ;
 
     addSwitchSet(file_options);
@@ -113,6 +145,120 @@ Stage& SortKernel::makeReader(Options readerOptions)
 }
 
 
+// Keys for the dimensions given, or for the curve if there are none.
+// Dimension names are resolved in the layout, as filters.sort does.
+SortKeyList SortKernel::sortKeys(const BOX3D& bounds,
+    PointLayoutPtr layout) const
+{
+    SortKeyList keys;
+    if (m_dims.empty())
+    {
+        SortKey::Type curve = SortKey::Morton;
+        if (m_curve == "hilbert")
+            curve = SortKey::Hilbert;
+        else if (m_curve == "morton3d")
+            curve = SortKey::Morton3d;
+        keys.push_back(SortKey(curve, bounds));
+        return keys;
+    }
+
+    Dimension::IdList ids;
+    for (size_t i = 0; i < m_dims.size(); ++i)
+    {
+        Dimension::Id::Enum id = layout->findDim(m_dims[i]);
+        if (id == Dimension::Id::Unknown)
+        {
+            std::ostringstream oss;
+            oss << "Can't sort on unknown dimension '" << m_dims[i] << "'.";
+            throw app_usage_error(oss.str());
+        }
+        std::string order = m_orders.empty() ? "ASC" :
+            m_orders[m_orders.size() == 1 ? 0 : i];
+        keys.push_back(SortKey(id, order == "DESC"));
+    }
+    return keys;
+}
+
+
+Stage& SortKernel::makeSortWriter(Stage& input)
+{
+    Options writerOptions;
+    writerOptions.add("filename", m_outputFile);
+    setCommonOptions(writerOptions);
+
+    if (m_bCompress)
+        writerOptions.add("compression", true);
+    if (m_bForwardMetadata)
+        writerOptions.add("forward_metadata", true);
+
+    std::vector<std::string> cmd = getProgressShellCommand();
+    UserCallback *callback =
+        cmd.size() ? (UserCallback *)new ShellScriptCallback(cmd) :
+        (UserCallback *)new HeartbeatCallback();
+
+    Stage& writer = makeWriter(m_outputFile, input);
+
+    // Some options are inferred by makeWriter based on filename
+    // (compression, driver type, etc).
+    writer.setOptions(writerOptions + writer.getOptions());
+    writer.setUserCallback(callback);
+    return writer;
+}
+
+
+// Sort input that doesn't fit in memory.  The input is streamed in runs
+// that fit in the memory allowed, and each run is sorted and written to a
+// temporary file.  The runs are then merged, a buffer's worth of each at
+// a time, and streamed to the writer.  Curves are computed within the
+// bounds from the input's header, so that every run uses the same ones.
+int SortKernel::executeExternal(Stage& readerStage)
+{
+    BOX3D bounds;
+    if (m_dims.empty())
+    {
+        QuickInfo qi = readerStage.preview();
+        if (!qi.valid() || qi.m_bounds.empty())
+        {
+            std::ostringstream oss;
+            oss << "Can't sort '" << m_inputFile << "' along a curve "
+                "without memory for all of it, since its bounds aren't "
+                "known in advance.  Sort on dimensions instead.";
+            throw pdal_error(oss.str());
+        }
+        bounds = qi.m_bounds;
+    }
+    size_t memory = m_runMemory * 1024 * 1024;
+
+    SortRunList runs(m_tmpDir);
+    StreamPointTable runTable(PointTable::DefaultBlockPtCnt);
+    SortRunWriter runWriter(SortKeyList(), runs,
+        GlobalEnvironment::get().threadPool());
+    runWriter.setInput(readerStage);
+    runWriter.prepare(runTable);
+    SortKeyList keys = sortKeys(bounds, runTable.layout());
+    runWriter.setKeys(keys);
+
+    // The points of a run are held in the table, as key/position pairs
+    // while they're sorted and as key values while they're written.
+    size_t pointBytes = runTable.layout()->pointSize() +
+        (keys.size() + 5) * sizeof(uint64_t);
+    runTable.setCapacity((std::max)((size_t)1, memory / pointBytes));
+    runWriter.execute(runTable);
+
+    StreamPointTable mergeTable(PointTable::DefaultBlockPtCnt);
+    mergeTable.setSpatialRef(runTable.spatialRef());
+    // Half the memory is for run buffers, the rest for chunks of output.
+    SortRunReader merger(runs, memory / 2);
+    Stage& writer = makeSortWriter(merger);
+    applyExtraStageOptionsRecursive(&writer);
+    writer.prepare(mergeTable);
+    mergeTable.setCapacity((std::max)((size_t)1,
+        memory / 2 / mergeTable.layout()->pointSize()));
+    writer.execute(mergeTable);
+    return 0;
+}
+
+
 int SortKernel::execute()
 {
     PointTable table;
@@ -123,6 +269,8 @@ int SortKernel::execute()
     readerOptions.add("verbose", getVerboseLevel());
 
     Stage& readerStage = makeReader(readerOptions);
+    if (m_runMemory)
+        return executeExternal(readerStage);
 
     // go ahead and prepare/execute on reader stage only to grab input
     // PointViewSet, this makes the input PointView available to both the
@@ -142,31 +290,20 @@ int SortKernel::execute()
     sortOptions.add<bool>("debug", isDebug());
     sortOptions.add<uint32_t>("verbose", getVerboseLevel());
 
+    for (auto& d : m_dims)
+        sortOptions.add("dimension", d);
+    for (auto& o : m_orders)
+        sortOptions.add("order", o);
+    if (m_dims.empty())
+        sortOptions.add("curve", m_curve);
+
     StageFactory f;
-    Stage& sortStage = ownStage(f.createStage("filters.mortonorder"));
+    Stage& sortStage = ownStage(f.createStage(m_dims.empty() ?
+        "filters.mortonorder" : "filters.sort"));
     sortStage.setInput(bufferReader);
     sortStage.setOptions(sortOptions);
 
-    Options writerOptions;
-    writerOptions.add("filename", m_outputFile);
-    setCommonOptions(writerOptions);
-
-    if (m_bCompress)
-        writerOptions.add("compression", true);
-    if (m_bForwardMetadata)
-        writerOptions.add("forward_metadata", true);
-
-    std::vector<std::string> cmd = getProgressShellCommand();
-    UserCallback *callback =
-        cmd.size() ? (UserCallback *)new ShellScriptCallback(cmd) :
-        (UserCallback *)new HeartbeatCallback();
-
-    Stage& writer = makeWriter(m_outputFile, sortStage);
-
-    // Some options are inferred by makeWriter based on filename
-    // (compression, driver type, etc).
-    writer.setOptions(writerOptions + writer.getOptions());
-    writer.setUserCallback(callback);
+    Stage& writer = makeSortWriter(sortStage);
 
     applyExtraStageOptionsRecursive(&writer);
     writer.prepare(table);
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Kernel.hpp>
+#include <pdal/PointSort.hpp>
 
 extern "C" int32_t SortKernel_ExitFunc();
 extern "C" PF_ExitFunc SortKernel_InitPlugin();
@@ -56,11 +57,19 @@ private:
     void validateSwitches();
 
     Stage& makeReader(Options readerOptions);
+    Stage& makeSortWriter(Stage& input);
+    SortKeyList sortKeys(const BOX3D& bounds, PointLayoutPtr layout) const;
+    int executeExternal(Stage& reader);
 
     std::string m_inputFile;
     std::string m_outputFile;
     bool m_bCompress;
     bool m_bForwardMetadata;
+    StringList m_dims;
+    StringList m_orders;
+    std::string m_curve;
+    uint64_t m_runMemory;
+    std::string m_tmpDir;
 };
 
 } // namespace pdal
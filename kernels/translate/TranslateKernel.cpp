@@ -35,6 +35,7 @@
 #include "TranslateKernel.hpp"
 
 #include <pdal/BufferReader.hpp>
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/KernelSupport.hpp>
 #include <pdal/StageFactory.hpp>
 #include <reprojection/ReprojectionFilter.hpp>
@@ -61,7 +62,9 @@ TranslateKernel::TranslateKernel() :
     m_input_srs(pdal::SpatialReference()),
     m_output_srs(pdal::SpatialReference()), m_bForwardMetadata(false),
     m_decimation_step(1), m_decimation_offset(0),
-    m_decimation_leaf_size(1), m_decimation_limit(0)
+    m_decimation_leaf_size(1), m_decimation_limit(0), m_streamChunk(0),
+    m_threads(1), m_table("row"), m_profile(false), m_memory(false),
+    m_memoryBudget(0), m_compact(0)
 {}
 
 
@@ -71,6 +74,11 @@ void TranslateKernel::validateSwitches()
         throw app_usage_error("--input/-i required");
     if (m_outputFile == "")
         throw app_usage_error("--output/-o required");
+    if (m_table != "row" && m_table != "column" && m_table != "mapped")
+        throw app_usage_error("--table must be 'row', 'column' or 'mapped'");
+    if (m_table != "row" && m_streamChunk)
+        throw app_usage_error("--table=" + m_table +
+            " can't be used with --stream");
     //
     // auto options = getExtraOptions();
     //
@@ -173,6 +181,35 @@ void TranslateKernel::addSwitches()
         ("d_limit",
          po::value<point_count_t>(&m_decimation_limit)->default_value(0),
          "Decimation limit")
+        ("stream",
+         po::value<point_count_t>(&m_streamChunk)->default_value(0),
+         "Process points in chunks of this many points so that memory use "
+         "doesn't depend on the size of the input (0 = read all points)")
+        ("threads", po::value<uint32_t>(&m_threads)->default_value(1),
+         "Number of threads used to run stages on separate point views "
+         "at the same time (0 = one per core)")
+        ("table", po::value<std::string>(&m_table)->default_value("row"),
+         "Point storage layout: 'row' (points interleaved), 'column' "
+         "(one array per dimension) or 'mapped' (points interleaved in a "
+         "memory-mapped scratch file)")
+        ("tmpdir", po::value<std::string>(&m_tmpDir),
+         "Directory for the scratch file of a 'mapped' point table "
+         "(default: system temporary directory)")
+        ("profile",
+         po::value<bool>(&m_profile)->zero_tokens()->implicit_value(true),
+         "Write the time, CPU use, point counts and table memory of "
+         "each stage to standard error as JSON")
+        ("memory",
+         po::value<bool>(&m_memory)->zero_tokens()->implicit_value(true),
+         "Write the current and peak memory used for points, views, "
+         "indexes and stage buffers to standard error as JSON")
+        ("memory-budget",
+         po::value<uint64_t>(&m_memoryBudget)->default_value(0),
+         "Fail as soon as the memory used for points, views, indexes "
+         "and stage buffers would exceed this many megabytes (0 = no limit)")
+        ("compact", po::value<double>(&m_compact)->default_value(0),
+         "Compact point storage after a stage leaves fewer than this "
+         "fraction of the table's points in use (0 = never)")
         ;
 
     addSwitchSet(file_options);
@@ -315,7 +352,21 @@ Stage& TranslateKernel::makeTranslate(Options translateOptions, Stage& parent)
 
 int TranslateKernel::execute()
 {
-    PointTable table;
+    GlobalEnvironment::get().setThreads(m_threads);
+    GlobalEnvironment::get().setProfiling(m_profile);
+
+    std::unique_ptr<BasePointTable> tablePtr;
+    if (m_streamChunk)
+        tablePtr.reset(new StreamPointTable(m_streamChunk));
+    else if (m_table == "column")
+        tablePtr.reset(new ColumnPointTable());
+    else if (m_table == "mapped")
+        tablePtr.reset(new MappedPointTable(m_tmpDir));
+    else
+        tablePtr.reset(new PointTable());
+    BasePointTable& table(*tablePtr);
+    table.memory()->setBudget(m_memoryBudget * 1024 * 1024);
+    table.setAutoCompact(m_compact);
 
     Options readerOptions;
     readerOptions.add("filename", m_inputFile);
@@ -354,8 +405,19 @@ int TranslateKernel::execute()
     applyExtraStageOptionsRecursive(&writer);
     writer.prepare(table);
 
+    if (m_streamChunk)
+    {
+        writer.execute(static_cast<StreamPointTable&>(table));
+        if (m_profile || m_memory)
+            writeReport(&writer,
+                m_memory ? table.memory() : MemoryTrackerPtr());
+        return 0;
+    }
+
     // process the data, grabbing the PointViewSet for visualization of the
     PointViewSet viewSetOut = writer.execute(table);
+    if (m_profile || m_memory)
+        writeReport(&writer, m_memory ? table.memory() : MemoryTrackerPtr());
 
     if (isVisualize())
         visualize(*viewSetOut.begin());
@@ -73,6 +73,14 @@ private:
     double m_decimation_leaf_size;
     std::string m_decimation_method;
     point_count_t m_decimation_limit;
+    point_count_t m_streamChunk;
+    uint32_t m_threads;
+    std::string m_table;
+    std::string m_tmpDir;
+    bool m_profile;
+    bool m_memory;
+    uint64_t m_memoryBudget;
+    double m_compact;
 };
 
 } // namespace pdal
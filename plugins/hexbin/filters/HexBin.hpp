@@ -52,6 +52,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const { return "filters.hexbin"; }
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y" };
+        return true;
+    }
 
 private:
 
@@ -76,6 +76,9 @@ protected:
         m_istream = NULL;
     }
 
+    virtual uint64_t fileOffset() const
+        { return m_offset; }
+
 private:
     uint64_t m_offset;
     uint64_t m_length;
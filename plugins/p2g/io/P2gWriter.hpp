@@ -71,6 +71,11 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    virtual bool usedDims(StringList& dims) const
+    {
+        dims = { "X", "Y", "Z" };
+        return true;
+    }
 
     Options getDefaultOptions();
 
@@ -50,6 +50,9 @@ public:
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
+    // The Python interpreter is shared by the whole process.
+    virtual bool branchSafe() const
+        { return false; }
 
     Options getDefaultOptions();
 
@@ -0,0 +1,183 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/BlockAllocator.hpp>
+
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+class HeapAllocator : public BlockAllocator
+{
+public:
+    virtual char *allocate(std::size_t size, bool zero)
+    {
+        char *buf = new (std::nothrow) char[size];
+        if (!buf)
+            throw pdal_error("Unable to allocate point table block.");
+        if (zero)
+            memset(buf, 0, size);
+        return buf;
+    }
+
+    virtual void release(char *buf, std::size_t /*size*/)
+        { delete [] buf; }
+};
+
+} // unnamed namespace
+
+
+BlockAllocator& BlockAllocator::heap()
+{
+    static HeapAllocator allocator;
+    return allocator;
+}
+
+
+PoolAllocator::PoolAllocator(std::size_t maxPooled, bool hugePages) :
+    m_pooled(0), m_maxPooled(maxPooled), m_hugePages(hugePages)
+{
+#ifdef _WIN32
+    m_hugePages = false;
+#endif
+}
+
+
+PoolAllocator::~PoolAllocator()
+{
+    clear();
+}
+
+
+char *PoolAllocator::allocate(std::size_t size, bool zero)
+{
+    char *buf = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto fi = m_free.find(size);
+        if (fi != m_free.end() && fi->second.size())
+        {
+            buf = fi->second.back();
+            fi->second.pop_back();
+            m_pooled -= size;
+        }
+    }
+
+    // Recycled blocks hold old points.  Fresh ones may already be zeroed.
+    bool zeroed = false;
+    if (!buf)
+        buf = systemAllocate(size, zeroed);
+    if (zero && !zeroed)
+        memset(buf, 0, size);
+    return buf;
+}
+
+
+void PoolAllocator::release(char *buf, std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_maxPooled == 0 || m_pooled + size <= m_maxPooled)
+        {
+            m_free[size].push_back(buf);
+            m_pooled += size;
+            return;
+        }
+    }
+    systemRelease(buf, size);
+}
+
+
+void PoolAllocator::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& f : m_free)
+        for (char *buf : f.second)
+            systemRelease(buf, f.first);
+    m_free.clear();
+    m_pooled = 0;
+}
+
+
+std::size_t PoolAllocator::pooledBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pooled;
+}
+
+
+char *PoolAllocator::systemAllocate(std::size_t size, bool& zeroed)
+{
+#ifndef _WIN32
+    if (m_hugePages)
+    {
+        // Anonymous mappings come from the kernel zero-filled.
+        void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED)
+            throw pdal_error("Unable to allocate point table block.");
+#ifdef MADV_HUGEPAGE
+        madvise(buf, size, MADV_HUGEPAGE);
+#endif
+        zeroed = true;
+        return (char *)buf;
+    }
+#endif
+    zeroed = false;
+    return BlockAllocator::heap().allocate(size, false);
+}
+
+
+void PoolAllocator::systemRelease(char *buf, std::size_t size)
+{
+#ifndef _WIN32
+    if (m_hugePages)
+    {
+        munmap(buf, size);
+        return;
+    }
+#endif
+    BlockAllocator::heap().release(buf, size);
+}
+
+} // namespace pdal
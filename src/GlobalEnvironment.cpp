@@ -32,12 +32,14 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
 #include <mutex>
 
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <pdal/GlobalEnvironment.hpp>
 #include <pdal/GDALUtils.hpp>
+#include <pdal/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -81,7 +83,8 @@ void GlobalEnvironment::shutdown()
 //
 
 GlobalEnvironment::GlobalEnvironment()
-    : m_gdalDebug()
+    : m_gdalDebug(), m_numThreads(1), m_maxBranches(0),
+      m_profiling(false)
 #ifdef PDAL_HAVE_PYTHON
     , m_pythonEnvironment()
 #endif
@@ -111,6 +114,32 @@ void GlobalEnvironment::initializeGDAL(LogPtr log, bool gdalDebugOutput)
 }
 
 
+void GlobalEnvironment::setThreads(size_t numThreads)
+{
+    if (numThreads == 0)
+        numThreads = (std::max)(std::thread::hardware_concurrency(), 1U);
+
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    if (numThreads != m_numThreads)
+    {
+        // The old pool finishes its queued work before it goes away.
+        m_threadPool.reset();
+        m_numThreads = numThreads;
+    }
+}
+
+
+ThreadPool *GlobalEnvironment::threadPool()
+{
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    if (m_numThreads <= 1)
+        return NULL;
+    if (!m_threadPool)
+        m_threadPool.reset(new ThreadPool(m_numThreads));
+    return m_threadPool.get();
+}
+
+
 #ifdef PDAL_HAVE_PYTHON
 void GlobalEnvironment::createPythonEnvironment()
 {
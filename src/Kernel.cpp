@@ -415,6 +415,38 @@ void Kernel::addHiddenSwitchSet(po::options_description* options)
 }
 
 
+namespace
+{
+
+void addProfiles(Stage *stage, MetadataNode& root)
+{
+    for (Stage *in : stage->getInputs())
+        addProfiles(in, root);
+
+    MetadataNodeList profiles = stage->getMetadata().children("profile");
+    if (profiles.empty())
+        return;
+    MetadataNode node = root.addList("stages");
+    node.add("name", stage->getName());
+    for (auto& child : profiles.front().children())
+        node.add(child);
+}
+
+} // unnamed namespace
+
+
+void Kernel::writeReport(Stage *stage, MemoryTrackerPtr memory)
+{
+    MetadataNode root;
+    addProfiles(stage, root);
+    if (memory)
+        memory->write(root);
+    // Writers can send points to standard output, so keep out of the way.
+    Utils::toJSON(root, std::cerr);
+    std::cerr << std::endl;
+}
+
+
 void Kernel::setCommonOptions(Options &options)
 {
     options.add("visualize", m_visualize);
@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/MemoryTracker.hpp>
+
+#include <sstream>
+
+namespace pdal
+{
+
+MemoryTracker::MemoryTracker() : m_budget(0)
+{
+    for (int i = 0; i <= NumCategories; ++i)
+    {
+        m_current[i] = 0;
+        m_peak[i] = 0;
+    }
+}
+
+
+void MemoryTracker::allocate(Category category, std::size_t bytes)
+{
+    std::atomic<std::size_t>& total = m_current[NumCategories];
+
+    std::size_t used = total.fetch_add(bytes) + bytes;
+    if (m_budget && used > m_budget)
+    {
+        total.fetch_sub(bytes);
+        std::ostringstream oss;
+        oss << "Memory budget of " << m_budget << " bytes exceeded: " <<
+            categoryName(category) << " needs " << bytes << " more bytes "
+            "with " << (used - bytes) << " bytes in use.";
+        throw pdal_error(oss.str());
+    }
+    raisePeak(m_peak[NumCategories], used);
+    raisePeak(m_peak[category], m_current[category].fetch_add(bytes) + bytes);
+}
+
+
+void MemoryTracker::release(Category category, std::size_t bytes)
+{
+    m_current[category].fetch_sub(bytes);
+    m_current[NumCategories].fetch_sub(bytes);
+}
+
+
+void MemoryTracker::raisePeak(std::atomic<std::size_t>& peak,
+    std::size_t value)
+{
+    std::size_t old = peak;
+    while (value > old && !peak.compare_exchange_weak(old, value))
+        ;
+}
+
+
+void MemoryTracker::write(MetadataNode parent) const
+{
+    MetadataNode node = parent.add("memory");
+    node.add("current_bytes", (uint64_t)current(), "Bytes in use");
+    node.add("peak_bytes", (uint64_t)peak(), "Most bytes in use at once");
+    if (m_budget)
+        node.add("budget_bytes", (uint64_t)m_budget, "Bytes allowed");
+    for (int i = 0; i < NumCategories; ++i)
+    {
+        Category c = (Category)i;
+        MetadataNode cat = node.add(categoryName(c));
+        cat.add("current_bytes", (uint64_t)current(c));
+        cat.add("peak_bytes", (uint64_t)peak(c));
+    }
+}
+
+
+const char *MemoryTracker::categoryName(Category category)
+{
+    switch (category)
+    {
+    case Table:
+        return "table";
+    case View:
+        return "view";
+    case Index:
+        return "index";
+    case StageData:
+        return "stage";
+    default:
+        return "";
+    }
+}
+
+} // namespace pdal
@@ -98,6 +98,7 @@ point_count_t PipelineManager::execute()
     if (!s)
         return 0;
     m_viewSet = s->execute(m_table);
+    m_table.memory()->write(m_table.metadata());
     point_count_t cnt = 0;
     for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
     {
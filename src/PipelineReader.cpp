@@ -35,6 +35,7 @@
 #include <pdal/PipelineReader.hpp>
 
 #include <pdal/Filter.hpp>
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -459,6 +460,36 @@ bool PipelineReader::parseElement_Pipeline(const ptree& tree)
     if (version != "1.0")
         throw pdal_error("PipelineReader: unsupported pipeline xml version");
 
+    if (attrs.count("threads"))
+    {
+        size_t threads;
+        try
+        {
+            threads = boost::lexical_cast<size_t>(attrs["threads"]);
+        }
+        catch (boost::bad_lexical_cast)
+        {
+            throw pdal_error("PipelineReader: invalid 'threads' attribute "
+                "of Pipeline element");
+        }
+        GlobalEnvironment::get().setThreads(threads);
+    }
+
+    if (attrs.count("branches"))
+    {
+        size_t branches;
+        try
+        {
+            branches = boost::lexical_cast<size_t>(attrs["branches"]);
+        }
+        catch (boost::bad_lexical_cast)
+        {
+            throw pdal_error("PipelineReader: invalid 'branches' attribute "
+                "of Pipeline element");
+        }
+        GlobalEnvironment::get().setMaxBranches(branches);
+    }
+
     bool isWriter = false;
 
     for (auto iter = tree.begin(); iter != tree.end(); ++iter)
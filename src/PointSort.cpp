@@ -0,0 +1,485 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/PointSort.hpp>
+
+#include <pdal/DimAccessor.hpp>
+#include <pdal/MemoryTracker.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/ThreadPool.hpp>
+
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace pdal
+{
+
+namespace
+{
+
+struct Entry
+{
+    uint64_t m_key;
+    PointId m_pos;
+};
+
+// Views smaller than this are sorted on the calling thread.
+const point_count_t MinParallelPoints = 1 << 18;
+
+// Call 'fn' for each chunk, on the pool's threads if there is a pool.
+void forEachChunk(ThreadPool *pool, size_t chunks,
+    const std::function<void(size_t)>& fn)
+{
+    if (!pool || chunks == 1)
+    {
+        for (size_t c = 0; c < chunks; ++c)
+            fn(c);
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        std::shared_ptr<std::packaged_task<void()>> task(
+            new std::packaged_task<void()>([&fn, c](){ fn(c); }));
+        futures.push_back(task->get_future());
+        pool->add([task](){ (*task)(); });
+    }
+    // Wait for every chunk before rethrowing, since they share buffers.
+    for (auto& f : futures)
+        pool->wait(f);
+    for (auto& f : futures)
+        f.get();
+}
+
+
+// Map values to unsigned integers that sort in the same order.
+inline uint64_t keyBits(uint8_t v)
+    { return v; }
+inline uint64_t keyBits(uint16_t v)
+    { return v; }
+inline uint64_t keyBits(uint32_t v)
+    { return v; }
+inline uint64_t keyBits(uint64_t v)
+    { return v; }
+inline uint64_t keyBits(int8_t v)
+    { return (uint8_t)v ^ 0x80u; }
+inline uint64_t keyBits(int16_t v)
+    { return (uint16_t)v ^ 0x8000u; }
+inline uint64_t keyBits(int32_t v)
+    { return (uint32_t)v ^ 0x80000000u; }
+inline uint64_t keyBits(int64_t v)
+    { return (uint64_t)v ^ 0x8000000000000000ull; }
+
+// Negative floating-point values have all their bits flipped so that larger
+// magnitudes sort first, positive ones just have the sign bit set.
+inline uint64_t keyBits(float v)
+{
+    uint32_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+inline uint64_t keyBits(double v)
+{
+    uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+}
+
+
+template<typename T>
+void extract(const PointView& view, const SortKey& key,
+    const std::vector<PointId>& order, Entry *entries, size_t begin,
+    size_t end)
+{
+    DimAccessor<T> acc(view.layout(), key.m_dim);
+    uint64_t flip = key.m_descending ? ~(uint64_t)0 : 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        entries[i].m_pos = order[i];
+        entries[i].m_key = keyBits(acc.get(view, order[i])) ^ flip;
+    }
+}
+
+
+// Scales coordinates within [min, max] to integers from 0 to 'top'.
+// Values outside the range are clamped.  The position within the range is
+// computed before it's scaled, as filters.mortonorder always has, so that
+// its order doesn't change with rounding.
+class Scaler
+{
+public:
+    Scaler(double min, double max, uint32_t top) : m_min(min),
+        m_range(max - min), m_top(top)
+    {}
+
+    uint32_t operator()(double v) const
+    {
+        if (!(m_range > 0))
+            return 0;
+        double d = (v - m_min) / m_range * m_top;
+        if (!(d > 0))
+            return 0;
+        if (d >= m_top)
+            return m_top;
+        return (uint32_t)d;
+    }
+
+private:
+    double m_min;
+    double m_range;
+    uint32_t m_top;
+};
+
+
+void extractCurve(const PointView& view, const SortKey& key,
+    const std::vector<PointId>& order, Entry *entries, size_t begin,
+    size_t end)
+{
+    DimAccessor<double> x(view.layout(), Dimension::Id::X);
+    DimAccessor<double> y(view.layout(), Dimension::Id::Y);
+    const BOX3D& b = key.m_bounds;
+
+    if (key.m_type == SortKey::Morton3d)
+    {
+        const uint32_t top = (1u << 21) - 1;
+        DimAccessor<double> z(view.layout(), Dimension::Id::Z);
+        Scaler sx(b.minx, b.maxx, top);
+        Scaler sy(b.miny, b.maxy, top);
+        Scaler sz(b.minz, b.maxz, top);
+        for (size_t i = begin; i < end; ++i)
+        {
+            PointId idx = order[i];
+            entries[i].m_pos = idx;
+            entries[i].m_key = PointSorter::mortonCode(sx(x.get(view, idx)),
+                sy(y.get(view, idx)), sz(z.get(view, idx)));
+        }
+        return;
+    }
+
+    // Morton codes have used 31 bits of each coordinate (INT_MAX), and
+    // keep doing so so that points come out in the same order.
+    const uint32_t top = (key.m_type == SortKey::Morton) ?
+        0x7FFFFFFFu : 0xFFFFFFFFu;
+    Scaler sx(b.minx, b.maxx, top);
+    Scaler sy(b.miny, b.maxy, top);
+    if (key.m_type == SortKey::Morton)
+        for (size_t i = begin; i < end; ++i)
+        {
+            PointId idx = order[i];
+            entries[i].m_pos = idx;
+            entries[i].m_key = PointSorter::mortonCode(sx(x.get(view, idx)),
+                sy(y.get(view, idx)));
+        }
+    else
+        for (size_t i = begin; i < end; ++i)
+        {
+            PointId idx = order[i];
+            entries[i].m_pos = idx;
+            entries[i].m_key = PointSorter::hilbertCode(sx(x.get(view, idx)),
+                sy(y.get(view, idx)));
+        }
+}
+
+
+void extract(const PointView& view, const SortKey& key,
+    const std::vector<PointId>& order, Entry *entries, size_t begin,
+    size_t end)
+{
+    using namespace Dimension;
+
+    if (key.m_type != SortKey::Dim)
+    {
+        extractCurve(view, key, order, entries, begin, end);
+        return;
+    }
+    switch (view.dimType(key.m_dim))
+    {
+    case Type::Float:
+        extract<float>(view, key, order, entries, begin, end);
+        break;
+    case Type::Double:
+        extract<double>(view, key, order, entries, begin, end);
+        break;
+    case Type::Signed8:
+        extract<int8_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Signed16:
+        extract<int16_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Signed32:
+        extract<int32_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Signed64:
+        extract<int64_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Unsigned8:
+        extract<uint8_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Unsigned16:
+        extract<uint16_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Unsigned32:
+        extract<uint32_t>(view, key, order, entries, begin, end);
+        break;
+    case Type::Unsigned64:
+        extract<uint64_t>(view, key, order, entries, begin, end);
+        break;
+    default:
+        break;
+    }
+}
+
+
+// Sort 'entries' by key with one counting pass per byte of the key.  Bytes
+// that are the same for every entry are skipped, so narrow types and keys
+// with a small range take few passes.  Each chunk counts and scatters its
+// own part of the array; a chunk's entries go after those of earlier chunks
+// with the same byte value, which keeps the sort stable.  The result may be
+// in either buffer, so a pointer to it is returned.
+Entry *radixSort(Entry *entries, Entry *temp, size_t count, size_t chunks,
+    ThreadPool *pool)
+{
+    typedef std::vector<size_t> Histogram;
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    auto range = [count, chunkSize](size_t c, size_t& begin, size_t& end)
+    {
+        begin = (std::min)(c * chunkSize, count);
+        end = (std::min)(begin + chunkSize, count);
+    };
+
+    // Count every byte up front to find the ones that vary.
+    std::vector<Histogram> byteHists(chunks, Histogram(8 * 256));
+    forEachChunk(pool, chunks, [&](size_t c)
+    {
+        size_t begin, end;
+        range(c, begin, end);
+        size_t *hist = byteHists[c].data();
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint64_t key = entries[i].m_key;
+            for (int b = 0; b < 8; ++b)
+                hist[b * 256 + ((key >> (8 * b)) & 0xFF)]++;
+        }
+    });
+
+    Entry *src = entries;
+    Entry *dst = temp;
+    std::vector<Histogram> hists(chunks, Histogram(256));
+    for (int b = 0; b < 8; ++b)
+    {
+        bool constant = false;
+        for (size_t v = 0; v < 256; ++v)
+        {
+            size_t total = 0;
+            for (size_t c = 0; c < chunks; ++c)
+                total += byteHists[c][b * 256 + v];
+            if (total)
+            {
+                constant = (total == count);
+                break;
+            }
+        }
+        if (constant)
+            continue;
+
+        int shift = 8 * b;
+        // After the first pass the entries have moved between chunks, so
+        // each chunk counts its entries again.
+        forEachChunk(pool, chunks, [&](size_t c)
+        {
+            size_t begin, end;
+            range(c, begin, end);
+            Histogram& hist = hists[c];
+            std::fill(hist.begin(), hist.end(), 0);
+            for (size_t i = begin; i < end; ++i)
+                hist[(src[i].m_key >> shift) & 0xFF]++;
+        });
+
+        // Turn the counts into the position of each chunk's first entry
+        // for each byte value.
+        size_t pos = 0;
+        for (size_t v = 0; v < 256; ++v)
+            for (size_t c = 0; c < chunks; ++c)
+            {
+                size_t cnt = hists[c][v];
+                hists[c][v] = pos;
+                pos += cnt;
+            }
+
+        forEachChunk(pool, chunks, [&](size_t c)
+        {
+            size_t begin, end;
+            range(c, begin, end);
+            Histogram& next = hists[c];
+            for (size_t i = begin; i < end; ++i)
+                dst[next[(src[i].m_key >> shift) & 0xFF]++] = src[i];
+        });
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+} // unnamed namespace
+
+
+std::vector<PointId> PointSorter::order(const PointView& view) const
+{
+    point_count_t count = view.size();
+    std::vector<PointId> order(count);
+    for (PointId i = 0; i < count; ++i)
+        order[i] = i;
+    if (count < 2)
+        return order;
+
+    size_t chunks = 1;
+    if (m_pool && count >= MinParallelPoints)
+        chunks = m_pool->numThreads();
+
+    MemoryCharge charge(view.memory(), MemoryTracker::StageData);
+    charge.set(2 * count * sizeof(Entry));
+    std::vector<Entry> entries(count);
+    std::vector<Entry> temp(count);
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (auto ki = m_keys.rbegin(); ki != m_keys.rend(); ++ki)
+    {
+        const SortKey& key = *ki;
+        if (key.m_type == SortKey::Dim && !view.hasDim(key.m_dim))
+            continue;
+
+        forEachChunk(m_pool, chunks, [&](size_t c)
+        {
+            size_t begin = (std::min)(c * chunkSize, (size_t)count);
+            size_t end = (std::min)(begin + chunkSize, (size_t)count);
+            extract(view, key, order, entries.data(), begin, end);
+        });
+        Entry *sorted = radixSort(entries.data(), temp.data(), count, chunks,
+            m_pool);
+        for (PointId i = 0; i < count; ++i)
+            order[i] = sorted[i].m_pos;
+    }
+    return order;
+}
+
+
+void PointSorter::sort(PointView& view) const
+{
+    view.reorder(order(view));
+}
+
+
+std::vector<uint64_t> PointSorter::keyValues(const PointView& view,
+    const SortKey& key)
+{
+    point_count_t count = view.size();
+    std::vector<uint64_t> values(count);
+    if (key.m_type == SortKey::Dim && !view.hasDim(key.m_dim))
+        return values;
+
+    std::vector<PointId> order(count);
+    for (PointId i = 0; i < count; ++i)
+        order[i] = i;
+    std::vector<Entry> entries(count);
+    extract(view, key, order, entries.data(), 0, count);
+    for (PointId i = 0; i < count; ++i)
+        values[i] = entries[i].m_key;
+    return values;
+}
+
+
+// Interleave the bits of 'x' and 'y', with each bit of 'x' above the bit of
+// 'y' at the same level.
+uint64_t PointSorter::mortonCode(uint32_t x, uint32_t y)
+{
+    auto spread = [](uint64_t v)
+    {
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        v = (v | (v << 1)) & 0x5555555555555555ull;
+        return v;
+    };
+    return (spread(x) << 1) | spread(y);
+}
+
+
+// Interleave the low 21 bits of each coordinate, 'x' highest.
+uint64_t PointSorter::mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    auto spread = [](uint64_t v)
+    {
+        v &= 0x1FFFFF;
+        v = (v | (v << 32)) & 0x001F00000000FFFFull;
+        v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+        v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+        v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+        v = (v | (v << 2)) & 0x1249249249249249ull;
+        return v;
+    };
+    return (spread(x) << 2) | (spread(y) << 1) | spread(z);
+}
+
+
+// Distance along a Hilbert curve filling a 2^32 x 2^32 grid.  Unlike the
+// Morton curve, consecutive positions are always adjacent cells.
+uint64_t PointSorter::hilbertCode(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = 0x80000000u; s; s >>= 1)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so the curve within it has the standard
+        // orientation.
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+} // namespace pdal
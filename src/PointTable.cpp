@@ -33,12 +33,34 @@
 ****************************************************************************/
 
 #include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace pdal
 {
 
+namespace
+{
+
+// Tables for branches of a pipeline that run concurrently share metadata.
+std::mutex s_srsMutex;
+
+} // unnamed namespace
+
+
 SpatialReference BasePointTable::spatialRef() const
 {
+    std::lock_guard<std::mutex> lock(s_srsMutex);
     MetadataNode m = m_metadata->m_private.findChild("spatialreference");
     SpatialReference sref;
     sref.setWKT(m.value());
@@ -48,15 +70,89 @@ SpatialReference BasePointTable::spatialRef() const
 
 void BasePointTable::setSpatialRef(const SpatialReference& sref)
 {
+    std::lock_guard<std::mutex> lock(s_srsMutex);
     MetadataNode mp = m_metadata->m_private;
     mp.addOrUpdate("spatialreference", sref.getRawWKT());
 }
 
 
+bool BasePointTable::compactIfSparse()
+{
+    if (m_compactFraction <= 0)
+        return false;
+
+    point_count_t live = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_views->m_mutex);
+        for (PointView *v : m_views->m_views)
+            live += v->m_index.size();
+    }
+    // Views may share points, so the sum is an upper bound on the number
+    // of points in use.
+    if (live >= m_compactFraction * numPoints())
+        return false;
+    return compact();
+}
+
+
+std::unique_ptr<BasePointTable> BasePointTable::makeBranch()
+{
+    return std::unique_ptr<BasePointTable>(new BranchPointTable(*this));
+}
+
+
+std::vector<PointId> BasePointTable::liveIds() const
+{
+    std::vector<PointId> ids;
+
+    std::lock_guard<std::mutex> lock(m_views->m_mutex);
+    for (PointView *v : m_views->m_views)
+    {
+        // Include the temporary entries past the end of the view.
+        const PointIdList& index = v->m_index;
+        for (size_t i = 0; i < index.size(); ++i)
+            ids.push_back(index[i]);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+
+void BasePointTable::remapViews(const std::vector<PointId>& live)
+{
+    std::lock_guard<std::mutex> lock(m_views->m_mutex);
+    for (PointView *v : m_views->m_views)
+    {
+        PointIdList& index = v->m_index;
+        std::vector<PointId> old(index.size());
+        for (size_t i = 0; i < old.size(); ++i)
+            old[i] = index[i];
+
+        index.clear();
+        PointId next = 0;
+        for (PointId id : old)
+        {
+            // Views are usually in table order, so try the position after
+            // the last one before searching.
+            if (next >= live.size() || live[next] != id)
+                next = std::lower_bound(live.begin(), live.end(), id) -
+                    live.begin();
+            index.push_back(next++);
+        }
+    }
+}
+
+
+const point_count_t PointTable::DefaultBlockPtCnt;
+
+
 PointTable::~PointTable()
 {
+    size_t size = pointsToBytes(m_blockPtCnt);
     for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+        m_allocator.release(*vi, size);
+    m_memory->release(MemoryTracker::Table, m_blocks.size() * size);
 }
 
 PointId PointTable::addPoint()
@@ -64,14 +160,94 @@ PointId PointTable::addPoint()
     if (m_numPts % m_blockPtCnt == 0)
     {
         size_t size = pointsToBytes(m_blockPtCnt);
-        char *buf = new char[size];
-        memset(buf, 0, size);
-        m_blocks.push_back(buf);
+        m_memory->allocate(MemoryTracker::Table, size);
+        try
+        {
+            m_blocks.push_back(m_allocator.allocate(size, m_zeroFill));
+        }
+        catch (...)
+        {
+            m_memory->release(MemoryTracker::Table, size);
+            throw;
+        }
     }
     return m_numPts++;
 }
 
 
+PointId StreamPointTable::addPoint()
+{
+    if (m_numPts >= m_capacity)
+        throw pdal_error("Can't add more points to a streaming point table "
+            "than its capacity.");
+
+    // Blocks survive a reset(), so only allocate when we've run past the
+    // storage we already have.
+    if (m_numPts == m_blocks.size() * m_blockPtCnt)
+        return PointTable::addPoint();
+    return m_numPts++;
+}
+
+
+void StreamPointTable::reset()
+{
+    // Zero the points that were used so that recycled storage looks like
+    // freshly allocated storage to the next chunk.
+    for (point_count_t i = 0; m_zeroFill && i < m_numPts; i += m_blockPtCnt)
+    {
+        point_count_t cnt = m_numPts - i;
+        if (cnt > m_blockPtCnt)
+            cnt = m_blockPtCnt;
+        memset(m_blocks[i / m_blockPtCnt], 0, pointsToBytes(cnt));
+    }
+    m_numPts = 0;
+}
+
+
+bool PointTable::compact()
+{
+    std::vector<PointId> live = liveIds();
+    point_count_t count = live.size();
+    if (count == m_numPts)
+        return false;
+
+    // The live IDs are sorted, so a point never moves to a slot that holds
+    // a point that's yet to be moved.
+    size_t pointSize = m_layout->pointSize();
+    for (PointId i = 0; i < count; ++i)
+        if (live[i] != i)
+            std::memcpy(getPoint(i), getPoint(live[i]), pointSize);
+
+    size_t size = pointsToBytes(m_blockPtCnt);
+    size_t keep = (count + m_blockPtCnt - 1) / m_blockPtCnt;
+    for (size_t b = keep; b < m_blocks.size(); ++b)
+        m_allocator.release(m_blocks[b], size);
+    m_memory->release(MemoryTracker::Table, (m_blocks.size() - keep) * size);
+    m_blocks.resize(keep);
+
+    // Points added later expect storage that hasn't been used.
+    if (m_zeroFill && count % m_blockPtCnt)
+    {
+        point_count_t end =
+            (std::min)((point_count_t)(keep * m_blockPtCnt), m_numPts);
+        std::memset(getPoint(count), 0, pointsToBytes(end - count));
+    }
+    m_numPts = count;
+    remapViews(live);
+    return true;
+}
+
+
+std::unique_ptr<BasePointTable> PointTable::makeBranch()
+{
+    PointTable *t = new PointTable(m_allocator, m_blockPtCnt, m_zeroFill);
+    std::unique_ptr<BasePointTable> branch(t);
+    *t->m_layout = *m_layout;
+    t->share(*this);
+    return branch;
+}
+
+
 char *PointTable::getPoint(PointId idx)
 {
     char *buf = m_blocks[idx / m_blockPtCnt];
@@ -90,5 +266,206 @@ void PointTable::getField(const Dimension::Detail *d, PointId idx, void *value)
     std::memcpy(value, getDimension(d, idx), d->size());
 }
 
+
+MappedPointTable::MappedPointTable(const std::string& tempDir) :
+    m_tempDir(tempDir), m_fd(-1), m_access(Access::Normal)
+{
+#ifdef _WIN32
+    throw pdal_error("Memory-mapped point tables aren't supported on "
+        "this platform.");
+#else
+    boost::filesystem::path dir(tempDir);
+    if (dir.empty())
+        dir = boost::filesystem::temp_directory_path();
+    std::string filename = (dir / "pdal_points_XXXXXX").string();
+
+    std::vector<char> name(filename.begin(), filename.end());
+    name.push_back(0);
+    m_fd = mkstemp(name.data());
+    if (m_fd < 0)
+    {
+        std::ostringstream oss;
+        oss << "Unable to create point table scratch file in '" << dir.string() <<
+            "': " << strerror(errno) << ".";
+        throw pdal_error(oss.str());
+    }
+    // The file stays around while we hold it open.
+    unlink(name.data());
+#endif
+}
+
+
+MappedPointTable::~MappedPointTable()
+{
+#ifndef _WIN32
+    size_t size = pointsToBytes(m_blockPtCnt);
+    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
+        munmap(*vi, size);
+    // Keep the base class from deleting mapped memory.
+    m_blocks.clear();
+    if (m_fd >= 0)
+        close(m_fd);
+#endif
+}
+
+
+PointId MappedPointTable::addPoint()
+{
+#ifndef _WIN32
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        // Block sizes are a multiple of the block point count and so are
+        // page aligned.  Growing the file doesn't write anything, so the
+        // new block reads as zeros without a memset.
+        size_t size = pointsToBytes(m_blockPtCnt);
+        off_t offset = (off_t)m_blocks.size() * size;
+        void *buf = MAP_FAILED;
+        if (ftruncate(m_fd, offset + size) == 0)
+            buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                m_fd, offset);
+        if (buf == MAP_FAILED)
+        {
+            std::ostringstream oss;
+            oss << "Unable to map point table block: " <<
+                strerror(errno) << ".";
+            throw pdal_error(oss.str());
+        }
+        advise((char *)buf, size);
+        m_blocks.push_back((char *)buf);
+    }
+#endif
+    return m_numPts++;
+}
+
+
+std::unique_ptr<BasePointTable> MappedPointTable::makeBranch()
+{
+    MappedPointTable *t = new MappedPointTable(m_tempDir);
+    std::unique_ptr<BasePointTable> branch(t);
+    *t->m_layout = *m_layout;
+    t->share(*this);
+    t->setAccess(m_access);
+    return branch;
+}
+
+
+void MappedPointTable::setAccess(Access access)
+{
+    m_access = access;
+    size_t size = pointsToBytes(m_blockPtCnt);
+    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
+        advise(*vi, size);
+}
+
+
+void MappedPointTable::advise(char *buf, std::size_t size)
+{
+#ifndef _WIN32
+    int advice = POSIX_MADV_NORMAL;
+    if (m_access == Access::Sequential)
+        advice = POSIX_MADV_SEQUENTIAL;
+    else if (m_access == Access::Random)
+        advice = POSIX_MADV_RANDOM;
+    posix_madvise(buf, size, advice);
+#endif
+}
+
+
+ColumnPointTable::~ColumnPointTable()
+{
+    size_t size = m_layout->pointSize() * m_blockPtCnt;
+    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
+        m_allocator.release(*vi, size);
+    m_memory->release(MemoryTracker::Table, m_blocks.size() * size);
+}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        size_t size = m_layout->pointSize() * m_blockPtCnt;
+        m_memory->allocate(MemoryTracker::Table, size);
+        try
+        {
+            m_blocks.push_back(m_allocator.allocate(size, true));
+        }
+        catch (...)
+        {
+            m_memory->release(MemoryTracker::Table, size);
+            throw;
+        }
+    }
+    return m_numPts++;
+}
+
+
+bool ColumnPointTable::compact()
+{
+    std::vector<PointId> live = liveIds();
+    point_count_t count = live.size();
+    if (count == m_numPts)
+        return false;
+
+    for (Dimension::Id::Enum id : m_layout->dims())
+    {
+        const Dimension::Detail *d = m_layout->dimDetail(id);
+        for (PointId i = 0; i < count; ++i)
+            if (live[i] != i)
+                std::memcpy(getDimension(d, i), getDimension(d, live[i]),
+                    d->size());
+
+        // Blocks are always zeroed when allocated, so clear the slots
+        // that were vacated in the last block we keep.
+        point_count_t end = (std::min)((point_count_t)
+            (((count + m_blockPtCnt - 1) / m_blockPtCnt) * m_blockPtCnt),
+            m_numPts);
+        if (end > count)
+            std::memset(getDimension(d, count), 0, (end - count) * d->size());
+    }
+
+    size_t size = m_layout->pointSize() * m_blockPtCnt;
+    size_t keep = (count + m_blockPtCnt - 1) / m_blockPtCnt;
+    for (size_t b = keep; b < m_blocks.size(); ++b)
+        m_allocator.release(m_blocks[b], size);
+    m_memory->release(MemoryTracker::Table, (m_blocks.size() - keep) * size);
+    m_blocks.resize(keep);
+
+    m_numPts = count;
+    remapViews(live);
+    return true;
+}
+
+
+std::unique_ptr<BasePointTable> ColumnPointTable::makeBranch()
+{
+    ColumnPointTable *t = new ColumnPointTable(m_allocator);
+    std::unique_ptr<BasePointTable> branch(t);
+    *t->m_layout = *m_layout;
+    t->share(*this);
+    return branch;
+}
+
+
+char *ColumnPointTable::getPoint(PointId /*idx*/)
+{
+    throw pdal_error("Can't access packed point data in a columnar "
+        "point table.");
+}
+
+
+void ColumnPointTable::setField(const Dimension::Detail *d, PointId idx,
+    const void *value)
+{
+    std::memcpy(getDimension(d, idx), value, d->size());
+}
+
+
+void ColumnPointTable::getField(const Dimension::Detail *d, PointId idx,
+    void *value)
+{
+    std::memcpy(value, getDimension(d, idx), d->size());
+}
+
 } // namespace pdal
 
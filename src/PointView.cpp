@@ -99,6 +99,62 @@ void PointView::calculateBounds(const PointViewSet& set, BOX3D& output)
 }
 
 
+point_count_t PointView::getSpan(PointId idx, point_count_t count,
+    char *& buf)
+{
+    if (idx >= size())
+        return 0;
+    PointId rawId = m_index[idx];
+    count = (std::min)(count, size() - idx);
+    count = (std::min)(count, m_pointTable.contiguousPoints(rawId));
+    if (count == 0)
+        return 0;
+
+    // The run ends where the index stops referring to consecutive points.
+    point_count_t num = 1;
+    if (m_index.isRange())
+        num = count;
+    while (num < count && m_index[idx + num] == rawId + num)
+        num++;
+    buf = m_pointTable.getPoint(rawId);
+    return num;
+}
+
+
+point_count_t PointView::appendSpan(point_count_t count, char *& buf)
+{
+    // Contiguity depends only on storage, so any point can be asked about.
+    if (count == 0 || m_pointTable.contiguousPoints(0) == 0)
+        return 0;
+    assert(m_temps.empty());
+
+    PointId rawId = m_pointTable.addPoint();
+    count = (std::min)(count, m_pointTable.contiguousPoints(rawId));
+    m_index.push_back(rawId);
+    for (point_count_t i = 1; i < count; ++i)
+        m_index.push_back(m_pointTable.addPoint());
+    m_size += count;
+    buf = m_pointTable.getPoint(rawId);
+    return count;
+}
+
+
+void PointView::reorder(const std::vector<PointId>& order)
+{
+    assert(order.size() == m_size);
+
+    std::vector<PointId> ids(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        ids[i] = m_index[order[i]];
+
+    clearTemps();
+    m_index.clear();
+    m_index.reserve(ids.size());
+    for (PointId id : ids)
+        m_index.push_back(id);
+}
+
+
 void PointView::dump(std::ostream& ostr) const
 {
     using std::endl;
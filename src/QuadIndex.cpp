@@ -534,11 +534,16 @@ struct QuadIndex::QImpl
             std::size_t depthBegin,
             std::size_t depthEnd) const;
 
+    // Charge the index's memory to the tracker of the view's table.  This
+    // is done before the index is built, from the number of points.
+    void track(const PointView& view);
+
     std::size_t m_topLevel;
     std::vector<std::shared_ptr<QuadPointRef> > m_pointRefVec;
     std::unique_ptr<Tree> m_tree;
     std::size_t m_depth;
     std::vector<std::size_t> m_fills;
+    MemoryCharge m_charge;
 };
 
 QuadIndex::QImpl::QImpl(const PointView& view, std::size_t topLevel)
@@ -547,7 +552,9 @@ QuadIndex::QImpl::QImpl(const PointView& view, std::size_t topLevel)
     , m_tree()
     , m_depth(0)
     , m_fills()
+    , m_charge(MemoryTracker::Index)
 {
+    track(view);
     m_pointRefVec.resize(view.size());
 
     double xMin(std::numeric_limits<double>::max());
@@ -591,7 +598,9 @@ QuadIndex::QImpl::QImpl(
     , m_tree()
     , m_depth(0)
     , m_fills()
+    , m_charge(MemoryTracker::Index)
 {
+    track(view);
     m_pointRefVec.resize(view.size());
 
     for (PointId i(0); i < view.size(); ++i)
@@ -624,6 +633,7 @@ QuadIndex::QImpl::QImpl(
     , m_tree()
     , m_depth(0)
     , m_fills()
+    , m_charge(MemoryTracker::Index)
 {
     m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
 
@@ -634,6 +644,19 @@ QuadIndex::QImpl::QImpl(
     }
 }
 
+void QuadIndex::QImpl::track(const PointView& view)
+{
+    // Each point adds at most one node to the tree.  Point references are
+    // allocated separately from their shared_ptr control blocks.
+    const std::size_t count(view.size());
+    std::size_t bytes = (count + 1) * sizeof(Tree) +
+        count * sizeof(std::shared_ptr<QuadPointRef>) +
+        count * (sizeof(QuadPointRef) + 2 * sizeof(long));
+
+    m_charge.setTracker(view.memory());
+    m_charge.set(bytes);
+}
+
 void QuadIndex::QImpl::getBounds(
         double& xMin,
         double& yMin,
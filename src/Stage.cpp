@@ -36,14 +36,63 @@
 #include <pdal/Stage.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/UserCallback.hpp>
+#include <pdal/Writer.hpp>
 
 #include "StageRunner.hpp"
 
+#include <deque>
 #include <memory>
+#include <set>
 
 namespace pdal
 {
 
+namespace
+{
+
+void collectStages(Stage *s, std::vector<Stage *>& stages)
+{
+    stages.push_back(s);
+    for (Stage *in : s->getInputs())
+        collectStages(in, stages);
+}
+
+
+// Copy the points of a view into a new view of another table with the
+// same layout.
+PointViewPtr copyView(PointView& src, BasePointTable& table)
+{
+    PointViewPtr dst(new PointView(table));
+    dst->reserve(src.size());
+
+    size_t pointSize = src.pointSize();
+    DimTypeList dims = src.dimTypes();
+    std::vector<char> buf(pointSize);
+    PointId idx = 0;
+    while (idx < src.size())
+    {
+        char *srcBuf;
+        char *dstBuf;
+        point_count_t num = src.getSpan(idx, src.size() - idx, srcBuf);
+        if (num)
+            num = dst->appendSpan(num, dstBuf);
+        if (num)
+        {
+            memcpy(dstBuf, srcBuf, num * pointSize);
+            idx += num;
+        }
+        else
+        {
+            src.getPackedPoint(dims, idx, buf.data());
+            dst->setPackedPoint(dims, dst->size(), buf.data());
+            idx++;
+        }
+    }
+    return dst;
+}
+
+} // unnamed namespace
+
 
 Stage::Stage()
   : m_callback(new UserCallback), m_progressFd(-1)
@@ -68,16 +117,110 @@ void Stage::Construct()
 {
     m_debug = false;
     m_verbose = 0;
+    m_allDimsNeeded = true;
+    m_predsPushed = false;
 }
 
 
 void Stage::prepare(PointTableRef table)
+{
+    std::vector<Stage *> stages;
+    collectStages(this, stages);
+    std::set<Stage *> seen;
+    std::set<Stage *> shared;
+    for (Stage *s : stages)
+    {
+        s->m_allDimsNeeded = false;
+        s->m_dimsNeeded.clear();
+        s->m_pushedPreds.clear();
+        s->m_predsPushed = false;
+        if (!seen.insert(s).second)
+            shared.insert(s);
+    }
+
+    // Whoever executes anything but a writer gets the resulting views
+    // and may look at any dimension.
+    pushDims(dynamic_cast<Writer *>(this) == nullptr,
+        std::set<std::string>());
+    pushPredicates(std::vector<Stage *>(), shared);
+    l_prepare(table);
+}
+
+
+// Push the dimensions needed downstream of this stage to its inputs,
+// adding those that this stage reads itself.
+void Stage::pushDims(bool all, const std::set<std::string>& dims)
+{
+    m_allDimsNeeded = m_allDimsNeeded || all;
+    m_dimsNeeded.insert(dims.begin(), dims.end());
+
+    StringList used;
+    bool inputAll = m_allDimsNeeded || !usedDims(used);
+    std::set<std::string> inputDims(m_dimsNeeded);
+    for (const std::string& name : used)
+        inputDims.insert(Utils::toupper(name));
+    for (Stage *in : m_inputs)
+        in->pushDims(inputAll, inputDims);
+}
+
+
+// Hand the predicates of the chain of predicate-only stages leading to
+// this one to the reader at the start of the chain, if it accepts them.
+// Stages whose output goes to more than one stage end a chain.
+void Stage::pushPredicates(std::vector<Stage *> chain,
+    const std::set<Stage *>& shared)
+{
+    if (shared.count(this))
+        chain.clear();
+
+    DimPredicateList preds;
+    if (m_inputs.empty())
+    {
+        for (Stage *s : chain)
+        {
+            preds.clear();
+            s->predicates(preds);
+            bool accepted = !s->m_predsPushed;
+            for (const DimPredicate& p : preds)
+                accepted = accepted && acceptsPredicate(p);
+            if (!accepted)
+                continue;
+            m_pushedPreds.insert(m_pushedPreds.end(), preds.begin(),
+                preds.end());
+            s->m_predsPushed = true;
+        }
+    }
+    else if (m_inputs.size() == 1 && predicates(preds))
+    {
+        chain.push_back(this);
+        m_inputs[0]->pushPredicates(chain, shared);
+    }
+    else
+    {
+        for (Stage *in : m_inputs)
+            in->pushPredicates(std::vector<Stage *>(), shared);
+    }
+}
+
+
+bool Stage::dimNeeded(const std::string& name) const
+{
+    return m_allDimsNeeded ||
+        m_dimsNeeded.find(Utils::toupper(name)) != m_dimsNeeded.end();
+}
+
+
+void Stage::l_prepare(PointTableRef table)
 {
     for (size_t i = 0; i < m_inputs.size(); ++i)
     {
         Stage *prev = m_inputs[i];
-        prev->prepare(table);
+        prev->l_prepare(table);
     }
+
+    m_profile.reset(GlobalEnvironment::get().profiling() ?
+        new StageProfile : NULL);
+    StageProfile::Timer timer(m_profile.get(), StageProfile::Prepare);
     l_processOptions(m_options);
     processOptions(m_options);
     l_initialize(table);
@@ -91,16 +234,40 @@ PointViewSet Stage::execute(PointTableRef table)
 {
     table.layout()->finalize();
 
+    // If this stage selects points, so may the stages feeding it.  Those
+    // are run here along with this one rather than executed themselves.
+    m_selectChain.clear();
+    Stage *first = this;
+    if (selects())
+    {
+        m_selectChain.push_back(this);
+        while (first->m_inputs.size() == 1 && first->m_inputs[0]->selects())
+        {
+            first = first->m_inputs[0];
+            m_selectChain.insert(m_selectChain.begin(), first);
+        }
+    }
+    std::vector<Stage *> fused(m_selectChain);
+    if (fused.size())
+        fused.pop_back();
+
     PointViewSet views;
-    if (m_inputs.empty())
+    if (first->m_inputs.empty())
     {
         views.insert(PointViewPtr(new PointView(table)));
     }
+    else if (first->m_inputs.size() > 1 &&
+        GlobalEnvironment::get().threadPool() &&
+        GlobalEnvironment::get().maxBranches() != 1 &&
+        first->independentInputs())
+    {
+        views = first->executeInputs(table);
+    }
     else
     {
-        for (size_t i = 0; i < m_inputs.size(); ++i)
+        for (size_t i = 0; i < first->m_inputs.size(); ++i)
         {
-            Stage *prev = m_inputs[i];
+            Stage *prev = first->m_inputs[i];
             PointViewSet temp = prev->execute(table);
             views.insert(temp.begin(), temp.end());
         }
@@ -109,10 +276,27 @@ PointViewSet Stage::execute(PointTableRef table)
     PointViewSet outViews;
     std::vector<StageRunnerPtr> runners;
 
-    ready(table);
+    // Views are only run concurrently when the stage says that's safe.
+    bool safe = threadSafe();
+    for (Stage *s : fused)
+        safe = safe && s->threadSafe();
+    ThreadPool *pool = NULL;
+    if (views.size() > 1 && safe)
+        pool = GlobalEnvironment::get().threadPool();
+
+    for (Stage *s : fused)
+    {
+        StageProfile::Timer timer(s->m_profile.get(), StageProfile::Ready);
+        s->ready(table);
+    }
+    StageProfile *profile = m_profile.get();
+    {
+        StageProfile::Timer timer(profile, StageProfile::Ready);
+        ready(table);
+    }
     for (auto const& it : views)
     {
-        StageRunnerPtr runner(new StageRunner(this, it));
+        StageRunnerPtr runner(new StageRunner(this, it, pool));
         runners.push_back(runner);
         runner->run();
     }
@@ -122,12 +306,285 @@ PointViewSet Stage::execute(PointTableRef table)
         PointViewSet temp = runner->wait();
         outViews.insert(temp.begin(), temp.end());
     }
-    l_done(table);
-    done(table);
+    for (Stage *s : fused)
+    {
+        StageProfile *p = s->m_profile.get();
+        {
+            StageProfile::Timer timer(p, StageProfile::Done);
+            s->l_done(table);
+            s->done(table);
+        }
+        if (p)
+        {
+            p->sampleTable(table.allocatedBytes());
+            p->sampleMemory(table.memory()->peak());
+            p->write(s->m_metadata);
+        }
+    }
+    if (profile)
+    {
+        profile->sampleTable(table.allocatedBytes());
+        profile->sampleMemory(table.memory()->peak());
+    }
+    {
+        StageProfile::Timer timer(profile, StageProfile::Done);
+        l_done(table);
+        done(table);
+    }
+    // Selecting stages count their points as they run.
+    if (profile && m_selectChain.empty())
+    {
+        point_count_t in = 0;
+        point_count_t out = 0;
+        for (auto const& v : views)
+            in += v->size();
+        for (auto const& v : outViews)
+            out += v->size();
+        profile->addPoints(in, out);
+    }
+    if (profile)
+        profile->write(m_metadata);
+
+    // Drop the input views first so that the points only they refer to
+    // aren't kept when the table is compacted.
+    views.clear();
+    runners.clear();
+    table.compactIfSparse();
     return outViews;
 }
 
 
+// Run a chain of selecting stages over a view, each one clearing the
+// points it drops from a shared selection, and make the view of the points
+// that are left.  The view itself is returned if every point is kept.
+PointViewPtr Stage::runSelection(const std::vector<Stage *>& stages,
+    PointViewPtr view)
+{
+    PointSelection sel(view->size());
+    for (Stage *s : stages)
+    {
+        point_count_t in = sel.count();
+        if (!in && s->dropsEmptyViews())
+            return PointViewPtr();
+        {
+            StageProfile::Timer timer(s->m_profile.get(), StageProfile::Run);
+            if (in)
+                s->select(*view, sel);
+        }
+        if (s->m_profile)
+            s->m_profile->addPoints(in, sel.count());
+    }
+    return sel.all() ? view : view->makeSubset(sel);
+}
+
+
+// Whether the input branches can execute at the same time: no stage may be
+// part of more than one branch and every stage must allow it.
+bool Stage::independentInputs() const
+{
+    std::set<Stage *> seen;
+    for (Stage *in : m_inputs)
+    {
+        std::vector<Stage *> stages;
+        collectStages(in, stages);
+        std::set<Stage *> branch(stages.begin(), stages.end());
+        for (Stage *s : branch)
+            if (!s->branchSafe() || !seen.insert(s).second)
+                return false;
+    }
+    return true;
+}
+
+
+// Execute input branches on the thread pool, each with its own point table
+// of the main table's kind, since tables don't allow points to be added
+// from several threads.  At most GlobalEnvironment::maxBranches() branches
+// (one per pool thread by default) run at once.  Branches finish in input
+// order: the points of each are copied to the main table and its table is
+// released before another branch starts, so at most that many branch
+// tables exist alongside the main one.
+PointViewSet Stage::executeInputs(PointTableRef table)
+{
+    GlobalEnvironment& env = GlobalEnvironment::get();
+    ThreadPool *pool = env.threadPool();
+    size_t limit = env.maxBranches();
+    if (limit == 0)
+        limit = pool->numThreads();
+
+    struct Branch
+    {
+        std::unique_ptr<BasePointTable> m_table;
+        std::future<PointViewSet> m_future;
+    };
+    std::deque<Branch> running;
+
+    PointViewSet views;
+    size_t next = 0;
+    try
+    {
+        while (next < m_inputs.size() || running.size())
+        {
+            while (next < m_inputs.size() && running.size() < limit)
+            {
+                Stage *prev = m_inputs[next++];
+                running.emplace_back();
+                Branch& b = running.back();
+                b.m_table = table.makeBranch();
+                BasePointTable *branchTable = b.m_table.get();
+                std::shared_ptr<std::packaged_task<PointViewSet()>> task(
+                    new std::packaged_task<PointViewSet()>(
+                        [prev, branchTable]()
+                            { return prev->execute(*branchTable); }));
+                b.m_future = task->get_future();
+                pool->add([task](){ (*task)(); });
+            }
+
+            // get() rethrows a branch's exception.  The branch's views
+            // must go before its table does.
+            Branch& b = running.front();
+            pool->wait(b.m_future);
+            {
+                PointViewSet temp = b.m_future.get();
+                for (auto& v : temp)
+                    views.insert(copyView(*v, table));
+            }
+            running.pop_front();
+        }
+    }
+    catch (...)
+    {
+        // A running branch uses its table, so wait for the others to
+        // finish before their tables are destroyed.
+        for (Branch& b : running)
+            if (b.m_future.valid())
+                pool->wait(b.m_future);
+        throw;
+    }
+    return views;
+}
+
+
+// Run the pipeline ending at this stage in chunks no larger than the
+// capacity of the table.  Each chunk is read by the source stage and pushed
+// through every downstream stage before the table is reset for the next one.
+void Stage::execute(StreamPointTable& table)
+{
+    // Collect the stages from the source to this one, making sure that all
+    // of them can process points a chunk at a time.
+    std::vector<Stage *> stages;
+    Stage *s = this;
+    while (true)
+    {
+        if (!s->streamable())
+        {
+            std::ostringstream oss;
+            oss << "Stage '" << s->getName() << "' can't be run in "
+                "streaming mode.";
+            throw pdal_error(oss.str());
+        }
+        stages.insert(stages.begin(), s);
+        if (s->m_inputs.empty())
+            break;
+        if (s->m_inputs.size() > 1)
+        {
+            std::ostringstream oss;
+            oss << "Stage '" << s->getName() << "' has multiple inputs and "
+                "can't be run in streaming mode.";
+            throw pdal_error(oss.str());
+        }
+        s = s->m_inputs[0];
+    }
+
+    table.layout()->finalize();
+    for (Stage *s : stages)
+    {
+        StageProfile::Timer timer(s->m_profile.get(), StageProfile::Ready);
+        s->ready(table);
+    }
+
+    Stage *source = stages.front();
+    point_count_t numRead = 0;
+    while (true)
+    {
+        table.reset();
+        PointViewPtr view(new PointView(table));
+        point_count_t cnt;
+        {
+            StageProfile::Timer timer(source->m_profile.get(),
+                StageProfile::Run);
+            cnt = source->readChunk(view, numRead, table.capacity());
+        }
+        if (cnt == 0)
+            break;
+        numRead += cnt;
+        if (source->m_profile)
+            source->m_profile->addPoints(0, view->size());
+
+        PointViewSet views;
+        views.insert(view);
+        for (auto si = stages.begin() + 1; si != stages.end(); ++si)
+        {
+            // Consecutive selecting stages make one view per input view.
+            auto end = si;
+            while (end != stages.end() && (*end)->selects())
+                ++end;
+            if (end != si)
+            {
+                std::vector<Stage *> chain(si, end);
+                PointViewSet outViews;
+                for (auto const& v : views)
+                {
+                    PointViewPtr out = runSelection(chain, v);
+                    if (out)
+                        outViews.insert(out);
+                }
+                views.swap(outViews);
+                si = end - 1;
+                continue;
+            }
+
+            StageProfile *profile = (*si)->m_profile.get();
+            PointViewSet outViews;
+            {
+                StageProfile::Timer timer(profile, StageProfile::Run);
+                for (auto const& v : views)
+                {
+                    PointViewSet temp = (*si)->run(v);
+                    outViews.insert(temp.begin(), temp.end());
+                }
+            }
+            if (profile)
+            {
+                point_count_t in = 0;
+                point_count_t out = 0;
+                for (auto const& v : views)
+                    in += v->size();
+                for (auto const& v : outViews)
+                    out += v->size();
+                profile->addPoints(in, out);
+            }
+            views.swap(outViews);
+        }
+    }
+
+    for (Stage *s : stages)
+    {
+        StageProfile *profile = s->m_profile.get();
+        {
+            StageProfile::Timer timer(profile, StageProfile::Done);
+            s->l_done(table);
+            s->done(table);
+        }
+        if (profile)
+        {
+            profile->sampleTable(table.allocatedBytes());
+            profile->sampleMemory(table.memory()->peak());
+            profile->write(s->m_metadata);
+        }
+    }
+}
+
+
 void Stage::l_initialize(PointTableRef table)
 {
     m_metadata = table.metadata().add(getName());
@@ -0,0 +1,157 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/StageProfile.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+const char *phaseName(StageProfile::Phase phase)
+{
+    switch (phase)
+    {
+    case StageProfile::Prepare:
+        return "prepare";
+    case StageProfile::Ready:
+        return "ready";
+    case StageProfile::Run:
+        return "run";
+    case StageProfile::Done:
+        return "done";
+    default:
+        return "";
+    }
+}
+
+} // unnamed namespace
+
+
+StageProfile::StageProfile() : m_pointsIn(0), m_pointsOut(0),
+    m_peakTableBytes(0), m_peakMemoryBytes(0)
+{
+    for (int i = 0; i < NumPhases; ++i)
+    {
+        m_wall[i] = 0;
+        m_cpu[i] = 0;
+    }
+}
+
+
+void StageProfile::add(Phase phase, double wall, double cpu)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wall[phase] += wall;
+    m_cpu[phase] += cpu;
+}
+
+
+void StageProfile::addPoints(point_count_t in, point_count_t out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pointsIn += in;
+    m_pointsOut += out;
+}
+
+
+void StageProfile::sampleTable(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peakTableBytes = (std::max)(m_peakTableBytes, bytes);
+}
+
+
+void StageProfile::sampleMemory(std::size_t peak)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peakMemoryBytes = (std::max)(m_peakMemoryBytes, peak);
+}
+
+
+void StageProfile::write(MetadataNode parent) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MetadataNode node = parent.add("profile");
+    for (int i = 0; i < NumPhases; ++i)
+    {
+        MetadataNode phase = node.add(phaseName((Phase)i));
+        phase.add("wall", m_wall[i], "Elapsed seconds");
+        phase.add("cpu", m_cpu[i], "CPU seconds");
+    }
+    node.add("points_in", m_pointsIn);
+    node.add("points_out", m_pointsOut);
+
+    // Readers have no points in, so use the points they produced.
+    point_count_t points = m_pointsIn ? m_pointsIn : m_pointsOut;
+    double rate = m_wall[Run] > 0 ? points / m_wall[Run] : 0;
+    node.add("points_per_second", rate);
+    node.add("peak_table_bytes", (uint64_t)m_peakTableBytes);
+    node.add("peak_memory_bytes", (uint64_t)m_peakMemoryBytes,
+        "Peak memory use of the pipeline when the stage finished");
+}
+
+
+double StageProfile::wallTime()
+{
+    using namespace std::chrono;
+
+    return duration_cast<duration<double>>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+
+double StageProfile::cpuTime()
+{
+#if defined(_WIN32) || !defined(CLOCK_THREAD_CPUTIME_ID)
+    // Process time is the best that's portable.
+    return (double)std::clock() / CLOCKS_PER_SEC;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+} // namespace pdal
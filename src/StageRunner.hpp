@@ -34,31 +34,76 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/ThreadPool.hpp>
 
 namespace pdal
 {
 
+// Runs a stage on a single view.  With a thread pool the run happens on
+// one of the pool's threads, otherwise it happens synchronously in run().
 class StageRunner
 {
 public:
-    StageRunner(Stage *s, PointViewPtr view) :
-        m_stage(s), m_view(view)
+    StageRunner(Stage *s, PointViewPtr view, ThreadPool *pool = NULL) :
+        m_stage(s), m_view(view), m_pool(pool)
     {}
 
-    // For now this is all synchronous
     void run()
-        { m_viewSet = m_stage->run(m_view); }
+    {
+        if (!m_pool)
+        {
+            m_viewSet = runStage(m_stage, m_view);
+            return;
+        }
 
+        Stage *stage = m_stage;
+        PointViewPtr view = m_view;
+        std::shared_ptr<std::packaged_task<PointViewSet()>> task(
+            new std::packaged_task<PointViewSet()>(
+                [stage, view]()
+                    { return runStage(stage, view); }));
+        m_future = task->get_future();
+        m_pool->add([task](){ (*task)(); });
+    }
+
+    // Exceptions thrown by the stage are rethrown here.
     PointViewSet wait()
-        { return m_viewSet; }
+    {
+        if (m_future.valid())
+        {
+            // Help with queued work instead of blocking.
+            m_pool->wait(m_future);
+            m_viewSet = m_future.get();
+        }
+        return m_viewSet;
+    }
 
 private:
     Stage *m_stage;
     PointViewPtr m_view;
+    ThreadPool *m_pool;
+    std::future<PointViewSet> m_future;
     PointViewSet m_viewSet;
+
+    // A selecting stage runs the chain of selecting stages set up when it
+    // was executed.
+    static PointViewSet runStage(Stage *stage, PointViewPtr view)
+    {
+        if (stage->m_selectChain.size())
+        {
+            PointViewSet viewSet;
+            PointViewPtr out = Stage::runSelection(stage->m_selectChain, view);
+            if (out)
+                viewSet.insert(out);
+            return viewSet;
+        }
+        StageProfile::Timer timer(stage->m_profile.get(), StageProfile::Run);
+        return stage->run(view);
+    }
 };
 typedef std::shared_ptr<StageRunner> StageRunnerPtr;
 
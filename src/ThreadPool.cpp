@@ -0,0 +1,145 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/ThreadPool.hpp>
+
+namespace pdal
+{
+
+ThreadPool::ThreadPool(size_t numThreads) : m_queued(0), m_next(0),
+    m_stop(false)
+{
+    if (numThreads == 0)
+        numThreads = 1;
+    for (size_t i = 0; i < numThreads; ++i)
+        m_queues.push_back(std::unique_ptr<Queue>(new Queue));
+    for (size_t i = 0; i < numThreads; ++i)
+        m_threads.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+
+// Queued tasks are run before the workers exit.
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (auto& t : m_threads)
+        t.join();
+}
+
+
+void ThreadPool::add(Task task)
+{
+    // Count the task before it can be taken, so that the count never
+    // drops below zero.  The pool lock is held so that a worker can't miss
+    // the wakeup between checking the count and waiting.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued++;
+    }
+    Queue& q = *m_queues[m_next++ % m_queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.m_mutex);
+        q.m_tasks.push_back(task);
+    }
+    m_cond.notify_one();
+}
+
+
+bool ThreadPool::runOne()
+{
+    Task task;
+    if (!take(m_queues.size(), task))
+        return false;
+    task();
+    return true;
+}
+
+
+// Take the newest task from our own queue, or failing that, the oldest
+// task from some other queue.  An 'id' that isn't a worker only steals.
+bool ThreadPool::take(size_t id, Task& task)
+{
+    if (id < m_queues.size())
+    {
+        Queue& q = *m_queues[id];
+        std::lock_guard<std::mutex> lock(q.m_mutex);
+        if (q.m_tasks.size())
+        {
+            task = q.m_tasks.back();
+            q.m_tasks.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        if (i == id)
+            continue;
+        Queue& q = *m_queues[i];
+        std::lock_guard<std::mutex> lock(q.m_mutex);
+        if (q.m_tasks.size())
+        {
+            task = q.m_tasks.front();
+            q.m_tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void ThreadPool::work(size_t id)
+{
+    while (true)
+    {
+        Task task;
+        if (take(id, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this](){ return m_stop || m_queued > 0; });
+        if (m_stop && m_queued == 0)
+            return;
+    }
+}
+
+} // namespace pdal
@@ -34,6 +34,15 @@
 
 #include <sys/stat.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -355,4 +364,75 @@ string FileUtils::readFileAsString(string const& filename)
     return string();
 }
 
+
+FileUtils::MapContext FileUtils::mapFile(const std::string& filename)
+{
+    MapContext ctx;
+#ifdef _WIN32
+    ctx.m_error = "Mapping files isn't supported on this platform.";
+#else
+    ctx.m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (ctx.m_fd < 0)
+    {
+        ctx.m_error = strerror(errno);
+        return ctx;
+    }
+
+    struct stat statbuf;
+    if (fstat(ctx.m_fd, &statbuf) != 0)
+        ctx.m_error = strerror(errno);
+    else if (!S_ISREG(statbuf.st_mode))
+        ctx.m_error = "Not a regular file.";
+    else if (statbuf.st_size == 0)
+        ctx.m_error = "File is empty.";
+    else
+    {
+        ctx.m_size = statbuf.st_size;
+        void *addr = mmap(NULL, ctx.m_size, PROT_READ, MAP_SHARED,
+            ctx.m_fd, 0);
+        if (addr == MAP_FAILED)
+            ctx.m_error = strerror(errno);
+        else
+        {
+            ctx.m_addr = (const char *)addr;
+            posix_madvise(addr, ctx.m_size, POSIX_MADV_SEQUENTIAL);
+        }
+    }
+    if (!ctx.m_addr)
+        unmapFile(ctx);
+#endif
+    return ctx;
+}
+
+
+void FileUtils::unmapFile(MapContext& ctx)
+{
+#ifndef _WIN32
+    if (ctx.m_addr)
+        munmap((void *)ctx.m_addr, ctx.m_size);
+    if (ctx.m_fd >= 0)
+        ::close(ctx.m_fd);
+#endif
+    ctx.m_addr = NULL;
+    ctx.m_size = 0;
+    ctx.m_fd = -1;
+}
+
+
+void FileUtils::prefetch(const MapContext& ctx, uint64_t offset,
+    uint64_t size)
+{
+#ifndef _WIN32
+    if (!ctx.m_addr || offset >= ctx.m_size)
+        return;
+    size = (std::min)(size, ctx.m_size - offset);
+
+    // The address given to the system must be page aligned.
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    uint64_t start = offset - offset % page;
+    posix_madvise((void *)(ctx.m_addr + start), size + (offset - start),
+        POSIX_MADV_WILLNEED);
+#endif
+}
+
 } // namespace pdal
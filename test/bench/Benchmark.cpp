@@ -0,0 +1,194 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <pdal/Metadata.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/StageProfile.hpp>
+#include <pdal/pdal_config.hpp>
+
+namespace pdal
+{
+namespace bench
+{
+
+void Timer::start()
+{
+    m_start = StageProfile::wallTime();
+}
+
+
+void Timer::stop()
+{
+    m_elapsed += StageProfile::wallTime() - m_start;
+}
+
+
+void Runner::add(const std::string& name, point_count_t points,
+    BenchFunc func)
+{
+    m_benchmarks.push_back(Benchmark{name, points, func});
+}
+
+
+std::vector<Result> Runner::run(const std::string& filter,
+    std::ostream& progress)
+{
+    std::vector<Result> results;
+
+    for (const Benchmark& b : m_benchmarks)
+    {
+        if (b.m_name.find(filter) == std::string::npos)
+            continue;
+
+        progress << std::left << std::setw(32) << b.m_name << std::flush;
+        std::vector<double> times;
+        double total = 0;
+        try
+        {
+            while (times.size() < m_minIterations || total < m_minTime)
+            {
+                Timer timer;
+                b.m_func(timer);
+                times.push_back(timer.elapsed());
+                total += timer.elapsed();
+            }
+        }
+        catch (Skip& s)
+        {
+            progress << "skipped: " << s.what() << std::endl;
+            continue;
+        }
+        std::sort(times.begin(), times.end());
+
+        Result r;
+        r.m_name = b.m_name;
+        r.m_points = b.m_points;
+        r.m_iterations = times.size();
+        r.m_min = times.front();
+        r.m_median = times[times.size() / 2];
+        r.m_mean = total / times.size();
+        results.push_back(r);
+
+        progress << std::right << std::setw(12) << std::fixed <<
+            std::setprecision(6) << r.m_median << " s" <<
+            std::setw(16) << std::setprecision(0) << r.pointsPerSecond() <<
+            " points/s" << std::endl;
+    }
+    return results;
+}
+
+
+void writeResults(const std::vector<Result>& results, std::ostream& out)
+{
+    MetadataNode root;
+
+    root.add("pdal_version", GetFullVersionString());
+    for (const Result& r : results)
+    {
+        MetadataNode n = root.addList("benchmarks");
+        n.add("name", r.m_name);
+        n.add("points", r.m_points);
+        n.add("iterations", (uint64_t)r.m_iterations);
+        n.add("min_seconds", r.m_min);
+        n.add("median_seconds", r.m_median);
+        n.add("mean_seconds", r.m_mean);
+        n.add("points_per_second", r.pointsPerSecond());
+    }
+    Utils::toJSON(root, out);
+    out << std::endl;
+}
+
+
+size_t compare(const std::vector<Result>& results,
+    const std::string& baselineFile, double threshold, std::ostream& out)
+{
+    using namespace boost::property_tree;
+
+    std::map<std::string, double> baseline;
+    try
+    {
+        ptree tree;
+        read_json(baselineFile, tree);
+        for (auto& b : tree.get_child("benchmarks"))
+            baseline[b.second.get<std::string>("name")] =
+                b.second.get<double>("median_seconds");
+    }
+    catch (ptree_error& err)
+    {
+        std::ostringstream oss;
+        oss << "Unable to read benchmark baseline '" << baselineFile <<
+            "': " << err.what();
+        throw pdal_error(oss.str());
+    }
+
+    size_t regressions = 0;
+    out << std::left << std::setw(32) << "benchmark" << std::right <<
+        std::setw(14) << "baseline (s)" << std::setw(14) << "current (s)" <<
+        std::setw(10) << "change" << std::endl;
+    for (const Result& r : results)
+    {
+        out << std::left << std::setw(32) << r.m_name << std::right <<
+            std::fixed << std::setprecision(6);
+        auto bi = baseline.find(r.m_name);
+        if (bi == baseline.end() || bi->second <= 0)
+        {
+            out << std::setw(14) << "-" << std::setw(14) << r.m_median <<
+                std::endl;
+            continue;
+        }
+        double change = (r.m_median / bi->second - 1) * 100;
+        out << std::setw(14) << bi->second << std::setw(14) << r.m_median <<
+            std::setw(9) << std::setprecision(1) << std::showpos <<
+            change << "%" << std::noshowpos;
+        if (change > threshold)
+        {
+            out << "  REGRESSION";
+            regressions++;
+        }
+        out << std::endl;
+    }
+    return regressions;
+}
+
+} // namespace bench
+} // namespace pdal
@@ -0,0 +1,132 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pdal
+{
+namespace bench
+{
+
+// Times the part of a benchmark iteration between start() and stop(), so
+// that setup done in the same function isn't counted.
+class Timer
+{
+public:
+    Timer() : m_start(0), m_elapsed(0)
+        {}
+
+    void start();
+    void stop();
+    double elapsed() const
+        { return m_elapsed; }
+
+private:
+    double m_start;
+    double m_elapsed;
+};
+
+// A function that runs one iteration of a benchmark, timing the part that
+// should be measured.
+typedef std::function<void(Timer&)> BenchFunc;
+
+// Thrown by a benchmark that can't run in this build (a missing optional
+// library, for example).  The benchmark is left out of the results.
+struct Skip : public std::runtime_error
+{
+    Skip(const std::string& reason) : std::runtime_error(reason)
+        {}
+};
+
+struct Benchmark
+{
+    std::string m_name;
+    // Number of points handled by an iteration, used to report throughput.
+    point_count_t m_points;
+    BenchFunc m_func;
+};
+
+struct Result
+{
+    std::string m_name;
+    point_count_t m_points;
+    size_t m_iterations;
+    double m_min;
+    double m_median;
+    double m_mean;
+
+    double pointsPerSecond() const
+        { return m_median > 0 ? m_points / m_median : 0; }
+};
+
+class Runner
+{
+public:
+    // Each benchmark is run at least 'minIterations' times and until it
+    // has been timed for at least 'minTime' seconds.
+    Runner(size_t minIterations, double minTime) :
+        m_minIterations(minIterations), m_minTime(minTime)
+        {}
+
+    void add(const std::string& name, point_count_t points, BenchFunc func);
+    // Run the benchmarks whose names contain 'filter' and return their
+    // results.  Progress is written to 'progress'.
+    std::vector<Result> run(const std::string& filter, std::ostream& progress);
+    const std::vector<Benchmark>& benchmarks() const
+        { return m_benchmarks; }
+
+private:
+    size_t m_minIterations;
+    double m_minTime;
+    std::vector<Benchmark> m_benchmarks;
+};
+
+// Write results as JSON.
+void writeResults(const std::vector<Result>& results, std::ostream& out);
+// Compare results against the JSON results of an earlier run, reporting to
+// 'out'.  Returns the number of benchmarks whose median time increased by
+// more than 'threshold' percent.
+size_t compare(const std::vector<Result>& results,
+    const std::string& baselineFile, double threshold, std::ostream& out);
+
+} // namespace bench
+} // namespace pdal
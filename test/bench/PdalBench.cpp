@@ -0,0 +1,566 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+// pdal_bench measures the throughput of PDAL's hot paths: point access,
+// LAS decoding and encoding, spatial indexes and commonly used filters and
+// writers.  Results are written as JSON and can be compared against the
+// results of an earlier run to catch performance regressions.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include <pdal/BufferReader.hpp>
+#include <pdal/DimAccessor.hpp>
+#include <pdal/KDIndex.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/QuadIndex.hpp>
+#include <pdal/StageWrapper.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include <ChipperFilter.hpp>
+#include <LasReader.hpp>
+#include <LasWriter.hpp>
+#include <SortFilter.hpp>
+#include <StatsFilter.hpp>
+#include <TextWriter.hpp>
+
+#include "Benchmark.hpp"
+#include "Support.hpp"
+
+namespace pdal
+{
+
+// Access to the encoder of LasWriter, which is private.
+class LasTester
+{
+public:
+    static void ready(LasWriter& w, PointTableRef table)
+        { w.readyTable(table); }
+    static size_t pointLen(LasWriter& w)
+        { return w.m_lasHeader.pointLen(); }
+    static point_count_t fillWriteBuf(LasWriter& w, const PointView& view,
+            PointId startId, std::vector<char>& buf)
+        { return w.fillWriteBuf(view, startId, buf); }
+};
+
+} // namespace pdal
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+const Dimension::IdList& lasDims()
+{
+    using namespace Dimension;
+
+    static const IdList dims { Id::X, Id::Y, Id::Z, Id::Intensity,
+        Id::ReturnNumber, Id::NumberOfReturns, Id::ScanDirectionFlag,
+        Id::EdgeOfFlightLine, Id::Classification, Id::ScanAngleRank,
+        Id::UserData, Id::PointSourceId, Id::GpsTime, Id::Red, Id::Green,
+        Id::Blue, Id::Infrared };
+    return dims;
+}
+
+
+// Register the standard LAS dimensions and fill a view with 'count' points
+// of random but plausible values.  The same seed is used every time so that
+// runs are comparable.
+PointViewPtr randomView(PointTableRef table, point_count_t count)
+{
+    using namespace Dimension;
+
+    for (Id::Enum id : lasDims())
+        table.layout()->registerDim(id);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> xy(0, 10000);
+    std::uniform_real_distribution<double> z(0, 500);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> word(0, 65535);
+    std::uniform_int_distribution<int> returns(1, 3);
+
+    PointViewPtr view(new PointView(table));
+    view->reserve(count);
+    for (PointId i = 0; i < count; ++i)
+    {
+        int numReturns = returns(gen);
+        view->setField(Id::X, i, xy(gen));
+        view->setField(Id::Y, i, xy(gen));
+        view->setField(Id::Z, i, z(gen));
+        view->setField(Id::Intensity, i, word(gen));
+        view->setField(Id::NumberOfReturns, i, numReturns);
+        view->setField(Id::ReturnNumber, i,
+            std::uniform_int_distribution<int>(1, numReturns)(gen));
+        view->setField(Id::ScanDirectionFlag, i, byte(gen) & 1);
+        view->setField(Id::EdgeOfFlightLine, i, byte(gen) & 1);
+        view->setField(Id::Classification, i, byte(gen) % 10);
+        view->setField(Id::ScanAngleRank, i, byte(gen) % 60 - 30);
+        view->setField(Id::UserData, i, byte(gen));
+        view->setField(Id::PointSourceId, i, word(gen));
+        view->setField(Id::GpsTime, i, i * .00001);
+        view->setField(Id::Red, i, word(gen));
+        view->setField(Id::Green, i, word(gen));
+        view->setField(Id::Blue, i, word(gen));
+        view->setField(Id::Infrared, i, word(gen));
+    }
+    return view;
+}
+
+
+// Write 'count' random points as LAS point format 'format', unless the
+// file has already been written.  Throws Skip if it can't be written (if
+// LAZ support for the format is missing, for example).
+void writeLas(const std::string& filename, int format, bool compress,
+    point_count_t count)
+{
+    if (FileUtils::fileExists(filename))
+        return;
+
+    PointTable table;
+    PointViewPtr view = randomView(table, count);
+
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("filename", filename);
+    opts.add("dataformat_id", format);
+    opts.add("minor_version", format >= 6 ? 4 : 2);
+    opts.add("compression", compress);
+    opts.add("scale_x", .01);
+    opts.add("scale_y", .01);
+    opts.add("scale_z", .01);
+
+    LasWriter writer;
+    writer.setOptions(opts);
+    writer.setInput(reader);
+    try
+    {
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    catch (pdal_error& err)
+    {
+        FileUtils::deleteFile(filename);
+        throw Skip(err.what());
+    }
+}
+
+
+point_count_t readLas(const std::string& filename, Timer& t)
+{
+    Options opts;
+    opts.add("filename", filename);
+
+    LasReader reader;
+    reader.setOptions(opts);
+    PointTable table;
+    reader.prepare(table);
+    t.start();
+    PointViewSet set = reader.execute(table);
+    t.stop();
+    return (*set.begin())->size();
+}
+
+
+point_count_t pointCount(const std::string& filename)
+{
+    Timer t;
+    return readLas(filename, t);
+}
+
+
+// Time a filter's run() on 'count' random points.
+void runFilter(Stage& filter, point_count_t count, Timer& t)
+{
+    PointTable table;
+    PointViewPtr view = randomView(table, count);
+
+    filter.prepare(table);
+    StageWrapper::ready(filter, table);
+    t.start();
+    StageWrapper::run(filter, view);
+    t.stop();
+    StageWrapper::done(filter, table);
+}
+
+
+void addBenchmarks(Runner& runner, point_count_t count,
+    std::vector<std::string>& tempFiles)
+{
+    using namespace Dimension;
+
+    runner.add("point_table_add_point", count, [count](Timer& t)
+    {
+        PointTable table;
+        table.layout()->registerDim(Id::X);
+        table.layout()->finalize();
+        PointView view(table);
+
+        t.start();
+        for (PointId i = 0; i < count; ++i)
+            view.setField(Id::X, i, 0.0);
+        t.stop();
+    });
+
+    runner.add("point_view_set_field", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+
+        t.start();
+        for (PointId i = 0; i < count; ++i)
+        {
+            view->setField(Id::X, i, (double)i);
+            view->setField(Id::Intensity, i, (uint16_t)i);
+        }
+        t.stop();
+    });
+
+    runner.add("point_view_get_field_as", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+
+        double sum = 0;
+        t.start();
+        for (PointId i = 0; i < count; ++i)
+        {
+            sum += view->getFieldAs<double>(Id::X, i);
+            sum += view->getFieldAs<int>(Id::Intensity, i);
+        }
+        t.stop();
+        // Keep the loop from being optimized away.
+        if (sum < 0)
+            std::cerr << sum;
+    });
+
+    // The same accesses as point_view_set_field and point_view_get_field_as,
+    // through accessors.
+    runner.add("dim_accessor_set", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+        DimAccessor<double> x(table.layout(), Id::X);
+        DimAccessor<uint16_t> intensity(table.layout(), Id::Intensity);
+
+        t.start();
+        for (PointId i = 0; i < count; ++i)
+        {
+            x.set(*view, i, (double)i);
+            intensity.set(*view, i, (uint16_t)i);
+        }
+        t.stop();
+    });
+
+    runner.add("dim_accessor_get", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+        DimAccessor<double> x(table.layout(), Id::X);
+        DimAccessor<int> intensity(table.layout(), Id::Intensity);
+
+        double sum = 0;
+        t.start();
+        for (PointId i = 0; i < count; ++i)
+        {
+            sum += x.get(*view, i);
+            sum += intensity.get(*view, i);
+        }
+        t.stop();
+        // Keep the loop from being optimized away.
+        if (sum < 0)
+            std::cerr << sum;
+    });
+
+    for (int format : { 0, 1, 2, 3, 6, 7, 8 })
+    {
+        for (bool compress : { false, true })
+        {
+            std::string name = std::string(compress ? "laz" : "las") +
+                "_read_fmt" + std::to_string(format);
+            // The point count is part of the name so that a file left by
+            // an interrupted run of a different size isn't reused.
+            std::string filename = Support::temppath("bench_" + name + "_" +
+                std::to_string(count) + (compress ? ".laz" : ".las"));
+            tempFiles.push_back(filename);
+            runner.add(name, count, [=](Timer& t)
+            {
+                writeLas(filename, format, compress, count);
+                readLas(filename, t);
+            });
+
+            if (compress)
+                continue;
+            runner.add("las_fill_write_buf_fmt" + std::to_string(format),
+                count, [filename, format, count](Timer& t)
+            {
+                writeLas(filename, format, false, count);
+
+                Options ropts;
+                ropts.add("filename", filename);
+                LasReader reader;
+                reader.setOptions(ropts);
+                PointTable table;
+                reader.prepare(table);
+                PointViewPtr view = *reader.execute(table).begin();
+
+                Options wopts;
+                wopts.add("filename", Support::temppath("bench_unused.las"));
+                wopts.add("dataformat_id", format);
+                wopts.add("minor_version", format >= 6 ? 4 : 2);
+                LasWriter writer;
+                writer.setOptions(wopts);
+                writer.prepare(table);
+                LasTester::ready(writer, table);
+
+                std::vector<char> buf(LasTester::pointLen(writer) * 65536);
+                t.start();
+                for (PointId idx = 0; idx < view->size();)
+                    idx += LasTester::fillWriteBuf(writer, *view, idx, buf);
+                t.stop();
+            });
+        }
+    }
+
+    // Files from the test data, for real-world point distributions.
+    std::string autzen = Support::datapath("autzen/autzen-thin.las");
+    runner.add("las_read_autzen_thin", pointCount(autzen), [autzen](Timer& t)
+        { readLas(autzen, t); });
+#ifdef PDAL_HAVE_LASZIP
+    std::string simple = Support::datapath("laz/simple.laz");
+    runner.add("laz_read_simple", pointCount(simple), [simple](Timer& t)
+        { readLas(simple, t); });
+#endif
+
+    runner.add("kd3_index_build", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+        KD3Index index(*view);
+
+        t.start();
+        index.build();
+        t.stop();
+    });
+
+    const point_count_t queries = 10000;
+    runner.add("kd3_index_query", queries, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+        KD3Index index(*view);
+        index.build();
+
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> xy(0, 10000);
+        std::uniform_real_distribution<double> z(0, 500);
+        size_t found = 0;
+        t.start();
+        for (point_count_t i = 0; i < queries; ++i)
+            found += index.neighbors(xy(gen), xy(gen), z(gen), 8).size();
+        t.stop();
+        if (found == 0)
+            std::cerr << "kd3_index_query found no points" << std::endl;
+    });
+
+    runner.add("quad_index_build", count, [count](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+
+        t.start();
+        QuadIndex index(*view);
+        t.stop();
+    });
+
+    runner.add("sort_filter", count, [count](Timer& t)
+    {
+        Options opts;
+        opts.add("dimension", "X");
+        SortFilter filter;
+        filter.setOptions(opts);
+        runFilter(filter, count, t);
+    });
+
+    runner.add("chipper_filter", count, [count](Timer& t)
+    {
+        Options opts;
+        opts.add("capacity", 5000);
+        ChipperFilter filter;
+        filter.setOptions(opts);
+        runFilter(filter, count, t);
+    });
+
+    runner.add("stats_filter", count, [count](Timer& t)
+    {
+        StatsFilter filter;
+        runFilter(filter, count, t);
+    });
+
+    std::string textFile = Support::temppath("bench_text_writer.txt");
+    tempFiles.push_back(textFile);
+    runner.add("text_writer", count, [count, textFile](Timer& t)
+    {
+        PointTable table;
+        PointViewPtr view = randomView(table, count);
+
+        Options opts;
+        opts.add("filename", textFile);
+        TextWriter writer;
+        writer.setOptions(opts);
+        writer.prepare(table);
+        StageWrapper::ready(writer, table);
+        t.start();
+        WriterWrapper::write(writer, view);
+        StageWrapper::done(writer, table);
+        t.stop();
+    });
+    tempFiles.push_back(Support::temppath("bench_unused.las"));
+}
+
+
+void usage(std::ostream& out)
+{
+    out << "usage: pdal_bench [options]\n"
+        "  --points N        Points used by each benchmark [500000]\n"
+        "  --filter TEXT     Only run benchmarks whose names contain TEXT\n"
+        "  --iterations N    Minimum iterations of each benchmark [3]\n"
+        "  --min-time SECS   Minimum time spent on each benchmark [0.5]\n"
+        "  --output FILE     Write JSON results to FILE [standard output]\n"
+        "  --baseline FILE   Compare with the JSON results of an earlier run\n"
+        "                    and exit with status 1 on a regression\n"
+        "  --threshold PCT   Slowdown of the median time, in percent, that\n"
+        "                    counts as a regression [10]\n"
+        "  --list            List the benchmarks and exit\n";
+}
+
+} // unnamed namespace
+
+
+int main(int argc, char *argv[])
+{
+    point_count_t count = 500000;
+    std::string filter;
+    size_t iterations = 3;
+    double minTime = .5;
+    std::string output;
+    std::string baseline;
+    double threshold = 10;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--list")
+            list = true;
+        else if (arg == "--help" || arg == "-h")
+        {
+            usage(std::cout);
+            return 0;
+        }
+        else if (hasValue && arg == "--points")
+            count = std::strtoull(argv[++i], NULL, 10);
+        else if (hasValue && arg == "--filter")
+            filter = argv[++i];
+        else if (hasValue && arg == "--iterations")
+            iterations = std::strtoul(argv[++i], NULL, 10);
+        else if (hasValue && arg == "--min-time")
+            minTime = std::atof(argv[++i]);
+        else if (hasValue && arg == "--output")
+            output = argv[++i];
+        else if (hasValue && arg == "--baseline")
+            baseline = argv[++i];
+        else if (hasValue && arg == "--threshold")
+            threshold = std::atof(argv[++i]);
+        else
+        {
+            std::cerr << "pdal_bench: invalid argument '" << arg << "'\n";
+            usage(std::cerr);
+            return 2;
+        }
+    }
+    if (count == 0)
+    {
+        std::cerr << "pdal_bench: --points must be greater than 0\n";
+        return 2;
+    }
+
+    std::vector<std::string> tempFiles;
+    size_t regressions = 0;
+    try
+    {
+        Runner runner((std::max)(iterations, (size_t)1), minTime);
+        addBenchmarks(runner, count, tempFiles);
+        if (list)
+        {
+            for (const Benchmark& b : runner.benchmarks())
+                std::cout << b.m_name << std::endl;
+        }
+        else
+        {
+            std::vector<Result> results = runner.run(filter, std::cerr);
+            if (output.empty())
+                writeResults(results, std::cout);
+            else
+            {
+                std::ofstream out(output);
+                if (!out)
+                    throw pdal_error("Unable to open '" + output +
+                        "' for output.");
+                writeResults(results, out);
+            }
+            if (baseline.size())
+                regressions = compare(results, baseline, threshold,
+                    std::cerr);
+        }
+    }
+    catch (pdal_error& err)
+    {
+        std::cerr << "pdal_bench: " << err.what() << std::endl;
+        for (const std::string& f : tempFiles)
+            FileUtils::deleteFile(f);
+        return 2;
+    }
+    for (const std::string& f : tempFiles)
+        FileUtils::deleteFile(f);
+    return regressions ? 1 : 0;
+}
@@ -169,3 +169,24 @@ TEST(FileUtilsTest, filename)
     std::string filename = "/foo//bar//baz.c";
     EXPECT_EQ(FileUtils::getFilename(filename), "baz.c");
 }
+
+TEST(FileUtilsTest, mapFile)
+{
+    const std::string filename = Support::datapath("text/text.txt");
+    std::string source = FileUtils::readFileIntoString(filename);
+
+    FileUtils::MapContext ctx = FileUtils::mapFile(filename);
+    ASSERT_TRUE(ctx.m_addr != NULL);
+    EXPECT_TRUE(ctx.m_error.empty());
+    EXPECT_EQ(std::string(ctx.m_addr, ctx.m_size), source);
+    FileUtils::prefetch(ctx, 10, 1000);
+    FileUtils::unmapFile(ctx);
+    EXPECT_TRUE(ctx.m_addr == NULL);
+
+#ifndef _WIN32
+    // Directories, like pipes, can't be mapped.
+    ctx = FileUtils::mapFile(Support::datapath("text"));
+    EXPECT_TRUE(ctx.m_addr == NULL);
+    EXPECT_FALSE(ctx.m_error.empty());
+#endif
+}
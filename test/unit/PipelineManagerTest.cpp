@@ -36,6 +36,7 @@
 
 #include "Support.hpp"
 
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/util/FileUtils.hpp>
 
@@ -71,6 +72,59 @@ TEST(PipelineManagerTest, basic)
 }
 
 
+namespace
+{
+
+// Turns on profiling for its lifetime, so that a failure or exception
+// doesn't leave it on for the tests that follow.
+class ProfilingGuard
+{
+public:
+    ProfilingGuard()
+        { GlobalEnvironment::get().setProfiling(true); }
+    ~ProfilingGuard()
+        { GlobalEnvironment::get().setProfiling(false); }
+};
+
+} // unnamed namespace
+
+TEST(PipelineManagerTest, profile)
+{
+    const char * outfile = "temp.las";
+    FileUtils::deleteFile(outfile);
+
+    PipelineManager mgr;
+
+    Options optsR;
+    optsR.add("filename", Support::datapath("las/1.2-with-color.las"));
+    Stage& reader = mgr.addReader("readers.las");
+    reader.setOptions(optsR);
+
+    Options optsW;
+    optsW.add("filename", outfile);
+    Stage& writer = mgr.addWriter("writers.las");
+    writer.setInput(reader);
+    writer.setOptions(optsW);
+
+    {
+        ProfilingGuard guard;
+        mgr.execute();
+    }
+
+    MetadataNodeList profiles = reader.getMetadata().children("profile");
+    ASSERT_EQ(profiles.size(), 1U);
+    MetadataNode prof = profiles.front();
+    EXPECT_EQ(prof.findChild("points_out").value<point_count_t>(), 1065U);
+    EXPECT_GE(prof.findChild("run:wall").value<double>(), 0.0);
+
+    profiles = writer.getMetadata().children("profile");
+    ASSERT_EQ(profiles.size(), 1U);
+    EXPECT_EQ(profiles.front().findChild("points_in").value<point_count_t>(),
+        1065U);
+    FileUtils::deleteFile(outfile);
+}
+
+
 //ABELL - Mosaic
 /**
 TEST(PipelineManagerTest, PipelineManagerTest_test2)
@@ -35,7 +35,11 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PointTable.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/Writer.hpp>
 #include <las/LasReader.hpp>
+#include <FauxReader.hpp>
+#include <RangeFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -176,3 +180,431 @@ TEST(PointTable, userView)
     EXPECT_TRUE(called);
 }
 
+
+namespace
+{
+
+// Writer that records what it sees so that streaming can be checked.
+class StreamCheckWriter : public Writer
+{
+public:
+    StreamCheckWriter() : m_count(0), m_maxViewSize(0), m_lastZ(-1.0)
+        {}
+
+    std::string getName() const
+        { return "writers.streamcheck"; }
+    virtual bool streamable() const
+        { return true; }
+
+    point_count_t m_count;
+    point_count_t m_maxViewSize;
+    double m_lastZ;
+
+private:
+    virtual void write(const PointViewPtr view)
+    {
+        m_count += view->size();
+        m_maxViewSize = std::max(m_maxViewSize, view->size());
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            double z = view->getFieldAs<double>(Dimension::Id::Z, idx);
+            EXPECT_GT(z, m_lastZ);
+            m_lastZ = z;
+        }
+    }
+};
+
+} // unnamed namespace
+
+TEST(PointTable, stream)
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ops.add("mode", "ramp");
+    ops.add("num_points", 1000);
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options rangeOps;
+    Options range;
+    range.add("min", 100);
+    range.add("max", 899);
+    Option dim("dimension", "Z");
+    dim.setOptions(range);
+    rangeOps.add(dim);
+
+    RangeFilter filter;
+    filter.setOptions(rangeOps);
+    filter.setInput(reader);
+
+    StreamCheckWriter writer;
+    writer.setInput(filter);
+
+    StreamPointTable table(64);
+    writer.prepare(table);
+    writer.execute(table);
+
+    EXPECT_EQ(writer.m_count, 800u);
+    EXPECT_LE(writer.m_maxViewSize, 64u);
+    EXPECT_FLOAT_EQ(writer.m_lastZ, 899.0);
+}
+
+TEST(PointTable, streamReject)
+{
+    Options ops;
+    ops.add("num_points", 100);
+    ops.add("mode", "constant");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    StageFactory f;
+    std::unique_ptr<Stage> sort(f.createStage("filters.sort"));
+    Options sortOps;
+    sortOps.add("dimension", "X");
+    sort->setOptions(sortOps);
+    sort->setInput(reader);
+
+    StreamCheckWriter writer;
+    writer.setInput(*sort);
+
+    StreamPointTable table(10);
+    writer.prepare(table);
+    EXPECT_THROW(writer.execute(table), pdal_error);
+}
+
+TEST(PointTable, column)
+{
+    auto readFile = [](BasePointTable& table) -> PointViewPtr
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+        LasReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        return *viewSet.begin();
+    };
+
+    PointTable rowTable;
+    ColumnPointTable colTable;
+    PointViewPtr rowView = readFile(rowTable);
+    PointViewPtr colView = readFile(colTable);
+
+    ASSERT_EQ(rowView->size(), colView->size());
+    Dimension::IdList dims = rowTable.layout()->dims();
+    EXPECT_EQ(dims.size(), colTable.layout()->dims().size());
+    for (PointId idx = 0; idx < rowView->size(); ++idx)
+        for (auto& d : dims)
+            EXPECT_DOUBLE_EQ(rowView->getFieldAs<double>(d, idx),
+                colView->getFieldAs<double>(d, idx));
+
+    EXPECT_THROW(colView->getPoint(0), pdal_error);
+}
+
+TEST(PointTable, mapped)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    PointTable table;
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    MappedPointTable mappedTable(Support::temppath());
+    mappedTable.setAccess(MappedPointTable::Access::Sequential);
+    LasReader mappedReader;
+    mappedReader.setOptions(ops);
+    mappedReader.prepare(mappedTable);
+    viewSet = mappedReader.execute(mappedTable);
+    PointViewPtr mappedView = *viewSet.begin();
+
+    ASSERT_EQ(view->size(), mappedView->size());
+    mappedTable.setAccess(MappedPointTable::Access::Random);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        EXPECT_EQ(memcmp(view->getPoint(idx), mappedView->getPoint(idx),
+            view->pointSize()), 0);
+
+    EXPECT_THROW(MappedPointTable("/nonexistent/directory"), pdal_error);
+}
+
+TEST(PointTable, branch)
+{
+    ColumnPointTable colTable;
+    colTable.layout()->registerDim(Dimension::Id::X);
+    colTable.layout()->finalize();
+    std::unique_ptr<BasePointTable> branch = colTable.makeBranch();
+    EXPECT_TRUE(dynamic_cast<ColumnPointTable *>(branch.get()));
+    EXPECT_EQ(branch->layout()->pointSize(), colTable.layout()->pointSize());
+    EXPECT_EQ(branch->memory(), colTable.memory());
+
+    MappedPointTable mappedTable(Support::temppath());
+    mappedTable.layout()->finalize();
+    branch = mappedTable.makeBranch();
+    EXPECT_TRUE(dynamic_cast<MappedPointTable *>(branch.get()));
+
+    PointTable rowTable;
+    rowTable.layout()->finalize();
+    branch = rowTable.makeBranch();
+    EXPECT_TRUE(dynamic_cast<PointTable *>(branch.get()));
+    EXPECT_FALSE(dynamic_cast<MappedPointTable *>(branch.get()));
+}
+
+TEST(PointTable, allocator)
+{
+    using namespace Dimension;
+
+    PoolAllocator pool;
+    size_t pointSize;
+    {
+        PointTable table(pool, 1000);
+        table.layout()->registerDim(Id::X);
+        table.layout()->registerDim(Id::Y);
+        table.layout()->finalize();
+        pointSize = table.layout()->pointSize();
+
+        PointView view(table);
+        for (PointId idx = 0; idx < 2500; ++idx)
+            view.setField(Id::X, idx, idx);
+
+        // Blocks hold 1000 points, so spans stop at the block boundary.
+        char *buf;
+        EXPECT_EQ(view.getSpan(0, 2500, buf), 1000u);
+        EXPECT_EQ(view.getSpan(1500, 2500, buf), 500u);
+        EXPECT_EQ(pool.pooledBytes(), 0u);
+    }
+    // The table's three blocks went back to the pool.
+    EXPECT_EQ(pool.pooledBytes(), 3 * 1000 * pointSize);
+
+    {
+        PointTable table(pool, 1000);
+        table.layout()->registerDim(Id::X);
+        table.layout()->registerDim(Id::Y);
+        table.layout()->finalize();
+
+        // Recycled blocks are zeroed by default.
+        PointView view(table);
+        view.setField(Id::X, 0, 1.0);
+        EXPECT_EQ(pool.pooledBytes(), 2 * 1000 * pointSize);
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::Y, 0), 0.0);
+    }
+    pool.clear();
+    EXPECT_EQ(pool.pooledBytes(), 0u);
+}
+
+TEST(PointTable, memory)
+{
+    using namespace Dimension;
+
+    PointTable table(BlockAllocator::heap(), 1000);
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Y);
+    table.layout()->finalize();
+    size_t blockSize = 1000 * table.layout()->pointSize();
+
+    MemoryTrackerPtr memory = table.memory();
+    memory->setBudget(3 * blockSize);
+    {
+        PointView view(table);
+        for (PointId idx = 0; idx < 2500; ++idx)
+            view.setField(Id::X, idx, idx);
+        EXPECT_EQ(memory->current(MemoryTracker::Table), 3 * blockSize);
+        // Consecutive IDs in the view's index take no storage.
+        EXPECT_EQ(memory->current(MemoryTracker::View), 0u);
+
+        // A view of every other point expands its index.
+        memory->setBudget(0);
+        PointView evens(table);
+        for (PointId idx = 0; idx < view.size(); idx += 2)
+            evens.appendPoint(view, idx);
+        EXPECT_GE(memory->current(MemoryTracker::View),
+            evens.size() * sizeof(PointId));
+    }
+    EXPECT_EQ(memory->current(MemoryTracker::View), 0u);
+    EXPECT_GT(memory->peak(MemoryTracker::View), 0u);
+    EXPECT_EQ(memory->peak(),
+        memory->current() + memory->peak(MemoryTracker::View));
+
+    // A fourth block would exceed the budget, so it isn't allocated.
+    memory->setBudget(3 * blockSize);
+    PointView view(table);
+    for (PointId idx = 0; idx < 500; ++idx)
+        view.setField(Id::X, idx, idx);
+    EXPECT_THROW(view.setField(Id::X, 500, 500.0), pdal_error);
+    EXPECT_EQ(memory->current(), 3 * blockSize);
+    EXPECT_EQ(table.allocatedBytes(), 3 * blockSize);
+
+    MetadataNode root;
+    memory->write(root);
+    EXPECT_EQ(root.findChild("memory:table:current_bytes").value<size_t>(),
+        3 * blockSize);
+}
+
+TEST(PointTable, compact)
+{
+    using namespace Dimension;
+
+    PointTable table(BlockAllocator::heap(), 1000);
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Y);
+    table.layout()->finalize();
+    size_t blockSize = 1000 * table.layout()->pointSize();
+    MemoryTrackerPtr memory = table.memory();
+
+    PointViewPtr tens;
+    PointViewPtr hundreds;
+    {
+        PointView view(table);
+        for (PointId idx = 0; idx < 2500; ++idx)
+        {
+            view.setField(Id::X, idx, idx);
+            view.setField(Id::Y, idx, 2 * idx);
+        }
+
+        // Keep every tenth point, backwards, and every hundredth, which are
+        // also in the first view.
+        tens = view.makeNew();
+        for (int i = 249; i >= 0; --i)
+            tens->appendPoint(view, i * 10);
+        hundreds = view.makeNew();
+        for (PointId idx = 0; idx < 2500; idx += 100)
+            hundreds->appendPoint(view, idx);
+        EXPECT_FALSE(table.compact());
+    }
+    EXPECT_EQ(table.numPoints(), 2500u);
+    EXPECT_TRUE(table.compact());
+    EXPECT_EQ(table.numPoints(), 250u);
+    EXPECT_EQ(table.allocatedBytes(), blockSize);
+    EXPECT_EQ(memory->current(MemoryTracker::Table), blockSize);
+    EXPECT_FALSE(table.compact());
+
+    ASSERT_EQ(tens->size(), 250u);
+    for (PointId idx = 0; idx < tens->size(); ++idx)
+    {
+        int x = 2490 - 10 * idx;
+        EXPECT_EQ(tens->getFieldAs<int>(Id::X, idx), x);
+        EXPECT_EQ(tens->getFieldAs<int>(Id::Y, idx), 2 * x);
+    }
+    ASSERT_EQ(hundreds->size(), 25u);
+    for (PointId idx = 0; idx < hundreds->size(); ++idx)
+        EXPECT_EQ(hundreds->getFieldAs<int>(Id::X, idx), (int)idx * 100);
+
+    // Points shared by views are still shared.
+    hundreds->setField(Id::Y, 0, -1);
+    EXPECT_EQ(tens->getFieldAs<int>(Id::Y, 249), -1);
+
+    // New points go after the compacted ones, in cleared storage.
+    PointView view(table);
+    view.setField(Id::X, 0, 5000);
+    EXPECT_EQ(view.getFieldAs<int>(Id::X, 0), 5000);
+    EXPECT_EQ(view.getFieldAs<int>(Id::Y, 0), 0);
+    EXPECT_EQ(table.numPoints(), 251u);
+    EXPECT_EQ(tens->getFieldAs<int>(Id::X, 0), 2490);
+}
+
+
+TEST(PointTable, compactColumn)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Intensity);
+    table.layout()->finalize();
+
+    PointViewPtr odds;
+    {
+        PointView view(table);
+        for (PointId idx = 0; idx < 70000; ++idx)
+        {
+            view.setField(Id::X, idx, idx);
+            view.setField(Id::Intensity, idx, idx % 1000);
+        }
+        odds = view.makeNew();
+        for (PointId idx = 1; idx < view.size(); idx += 2)
+            odds->appendPoint(view, idx);
+    }
+    size_t blocks = table.allocatedBytes();
+    EXPECT_TRUE(table.compact());
+    EXPECT_EQ(table.numPoints(), 35000u);
+    EXPECT_EQ(table.allocatedBytes(), blocks / 2);
+    ASSERT_EQ(odds->size(), 35000u);
+    for (PointId idx = 0; idx < odds->size(); ++idx)
+    {
+        EXPECT_EQ(odds->getFieldAs<int>(Id::X, idx), 2 * (int)idx + 1);
+        EXPECT_EQ(odds->getFieldAs<int>(Id::Intensity, idx),
+            (2 * (int)idx + 1) % 1000);
+    }
+}
+
+
+TEST(PointTable, autoCompact)
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 2499, 2499, 2499));
+    ops.add("mode", "ramp");
+    ops.add("num_points", 2500);
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options rangeOps;
+    Options range;
+    range.add("min", 100);
+    range.add("max", 199);
+    Option dim("dimension", "Z");
+    dim.setOptions(range);
+    rangeOps.add(dim);
+
+    RangeFilter filter;
+    filter.setOptions(rangeOps);
+    filter.setInput(reader);
+
+    PointTable table(BlockAllocator::heap(), 1000);
+    table.setAutoCompact(0.5);
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(table.numPoints(), 100u);
+    EXPECT_EQ(table.allocatedBytes(), 1000 * table.layout()->pointSize());
+    ASSERT_EQ(view->size(), 100u);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Z, idx),
+            100.0 + idx);
+}
+
+TEST(PointTable, memoryIdList)
+{
+    MemoryTrackerPtr memory(new MemoryTracker);
+    memory->setBudget(100 * sizeof(PointId));
+
+    PointIdList ids;
+    ids.track(memory);
+    // Descending IDs have to be stored.
+    size_t stored = 0;
+    bool failed = false;
+    for (PointId id = 0; id < 1000 && !failed; ++id)
+    {
+        try
+        {
+            ids.push_back(1000 - id);
+            stored++;
+        }
+        catch (pdal_error&)
+        {
+            failed = true;
+        }
+    }
+    EXPECT_TRUE(failed);
+    // Storage is charged before it's allocated, so the ID that didn't fit
+    // isn't stored and the list stays within the budget.
+    EXPECT_EQ(ids.size(), stored);
+    EXPECT_EQ(ids[stored - 1], 1000 - (stored - 1));
+    EXPECT_LE(memory->current(), memory->budget());
+}
@@ -38,6 +38,7 @@
 
 #include <boost/property_tree/xml_parser.hpp>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -446,3 +447,254 @@ TEST(PointViewTest, order)
         pi = si;
     }
 }
+
+TEST(PointViewTest, span)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Intensity);
+    table.layout()->finalize();
+    size_t xOff = table.layout()->dimOffset(Id::X);
+    size_t iOff = table.layout()->dimOffset(Id::Intensity);
+
+    // Spans never cross a 65536-point block.
+    PointView view(table);
+    const point_count_t COUNT(100000);
+    point_count_t total = 0;
+    while (total < COUNT)
+    {
+        char *buf;
+        point_count_t num = view.appendSpan(COUNT - total, buf);
+        ASSERT_GT(num, 0u);
+        EXPECT_LE(num, 65536u);
+        for (point_count_t i = 0; i < num; ++i)
+        {
+            double x = (double)(total + i);
+            uint16_t intensity = (uint16_t)(total + i);
+            char *pos = buf + i * view.pointSize();
+            memcpy(pos + xOff, &x, sizeof(x));
+            memcpy(pos + iOff, &intensity, sizeof(intensity));
+        }
+        total += num;
+    }
+    EXPECT_EQ(view.size(), COUNT);
+    for (PointId idx = 0; idx < COUNT; idx += 997)
+    {
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, idx), (double)idx);
+        EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, idx),
+            (uint16_t)idx);
+    }
+
+    char *buf;
+    EXPECT_EQ(view.getSpan(0, COUNT, buf), 65536u);
+    EXPECT_EQ(view.getSpan(65536, COUNT, buf), COUNT - 65536);
+    EXPECT_EQ(view.getSpan(COUNT, 10, buf), 0u);
+
+    // Runs stop where the view's order departs from the table's.
+    PointView reordered(table);
+    for (PointId idx = 0; idx < 10; ++idx)
+        reordered.appendPoint(view, idx);
+    reordered.appendPoint(view, 20);
+    EXPECT_EQ(reordered.getSpan(0, 100, buf), 10u);
+    EXPECT_DOUBLE_EQ(*(double *)(buf + xOff), 0.0);
+    EXPECT_EQ(reordered.getSpan(10, 100, buf), 1u);
+    EXPECT_DOUBLE_EQ(*(double *)(buf + xOff), 20.0);
+
+    // Columnar tables don't store packed records.
+    ColumnPointTable colTable;
+    colTable.layout()->registerDim(Id::X);
+    colTable.layout()->finalize();
+    PointView colView(colTable);
+    EXPECT_EQ(colView.appendSpan(10, buf), 0u);
+    EXPECT_EQ(colView.size(), 0u);
+}
+
+namespace
+{
+
+void testAccessor(BasePointTable& table)
+{
+    using namespace Dimension;
+
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::Classification);
+    layout->finalize();
+
+    DimAccessor<double> x(layout, Id::X);
+    DimAccessor<double> intensity(layout, Id::Intensity);
+    DimAccessor<int> classification(layout, Id::Classification);
+    DimAccessor<double> missing(layout, Id::Red);
+
+    PointView view(table);
+    for (PointId idx = 0; idx < 100; ++idx)
+    {
+        x.set(view, idx, idx * 1.5);
+        intensity.set(view, idx, (double)idx * 100);
+        classification.set(view, idx, (int)idx);
+    }
+    EXPECT_EQ(view.size(), 100u);
+    for (PointId idx = 0; idx < 100; ++idx)
+    {
+        EXPECT_DOUBLE_EQ(x.get(view, idx), idx * 1.5);
+        EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, idx), idx * 100);
+        EXPECT_DOUBLE_EQ(intensity.get(view, idx), idx * 100.0);
+        EXPECT_EQ(classification.get(view, idx), (int)idx);
+        EXPECT_DOUBLE_EQ(missing.get(view, idx), 0.0);
+    }
+
+    // A view whose points aren't in table order.
+    PointView reversed(table);
+    for (PointId idx = 0; idx < 100; ++idx)
+        reversed.appendPoint(view, 99 - idx);
+    for (PointId idx = 0; idx < 100; ++idx)
+    {
+        EXPECT_DOUBLE_EQ(x.get(reversed, idx), (99 - idx) * 1.5);
+        classification.set(reversed, idx, (int)idx);
+        EXPECT_EQ(view.getFieldAs<int>(Id::Classification, 99 - idx),
+            (int)idx);
+    }
+
+    // Runs of packed records are set in one call.
+    PointView appended(table);
+    std::vector<int> classes;
+    for (int i = 0; i < 40; ++i)
+        classes.push_back(i + 1);
+    char *buf;
+    point_count_t cnt = appended.appendSpan(classes.size(), buf);
+    if (cnt)
+    {
+        classification.setSpan(buf, cnt, classes.data());
+        for (PointId idx = 0; idx < cnt; ++idx)
+            EXPECT_EQ(classification.get(appended, idx), (int)idx + 1);
+        classes[cnt - 1] = -1;
+        EXPECT_THROW(classification.setSpan(buf, cnt, classes.data()),
+            pdal_error);
+    }
+
+    // Values are range-checked like getFieldAs()/setField().
+    EXPECT_THROW(intensity.set(view, 0, 100000.0), pdal_error);
+    EXPECT_THROW(classification.set(view, 0, -1), pdal_error);
+    x.set(view, 0, 1e10);
+    DimAccessor<int> xInt(layout, Id::X);
+    EXPECT_THROW(xInt.get(view, 0), pdal_error);
+}
+
+} // unnamed namespace
+
+// Row tables are accessed directly, in blocks of 16 points here so that
+// the points span several blocks.  Column tables go through the table.
+TEST(PointViewTest, accessor)
+{
+    PointTable table;
+    testAccessor(table);
+
+    PointTable smallBlocks(BlockAllocator::heap(), 16);
+    testAccessor(smallBlocks);
+
+    ColumnPointTable colTable;
+    testAccessor(colTable);
+}
+
+TEST(PointViewTest, idList)
+{
+    PointIdList l;
+    for (PointId i = 5; i < 15; ++i)
+        l.push_back(i);
+    EXPECT_TRUE(l.isRange());
+    EXPECT_EQ(l.size(), 10u);
+    EXPECT_EQ(l[3], 8u);
+
+    PointIdList m;
+    m.insert(0, l, 10);
+    EXPECT_TRUE(m.isRange());
+    EXPECT_EQ(m[0], 5u);
+
+    // Setting an ID to the value it already has doesn't expand the list.
+    l.set(2, 7);
+    EXPECT_TRUE(l.isRange());
+    l.set(2, 100);
+    EXPECT_FALSE(l.isRange());
+    EXPECT_EQ(l[2], 100u);
+    EXPECT_EQ(l[3], 8u);
+
+    m.insert(3, l, 4);
+    EXPECT_FALSE(m.isRange());
+    EXPECT_EQ(m.size(), 14u);
+    EXPECT_EQ(m[3], 5u);
+    EXPECT_EQ(m[5], 100u);
+    EXPECT_EQ(m[6], 8u);
+    EXPECT_EQ(m[7], 8u);
+    EXPECT_EQ(m[8], 9u);
+}
+
+TEST(PointViewTest, reserve)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->finalize();
+
+    PointView view(table);
+    view.reserve(100000);
+    EXPECT_EQ(view.size(), 0u);
+    for (PointId idx = 0; idx < 100000; ++idx)
+        view.setField(Dimension::Id::X, idx, idx);
+    EXPECT_EQ(view.size(), 100000u);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Dimension::Id::X, 99999),
+        99999.0);
+}
+
+TEST(PointViewTest, selection)
+{
+    PointSelection sel(200);
+    EXPECT_TRUE(sel.all());
+    EXPECT_EQ(sel.first(), 0u);
+    for (PointId idx = 0; idx < 200; ++idx)
+        if (idx % 3)
+            sel.clear(idx);
+    // Clearing twice doesn't change the count.
+    sel.clear(1);
+    EXPECT_EQ(sel.count(), 67u);
+    EXPECT_FALSE(sel.all());
+    EXPECT_TRUE(sel.selected(198));
+    EXPECT_FALSE(sel.selected(199));
+
+    PointSelection low(200);
+    for (PointId idx = 100; idx < 200; ++idx)
+        low.clear(idx);
+    sel &= low;
+    EXPECT_EQ(sel.count(), 34u);
+
+    point_count_t cnt = 0;
+    PointId last = 0;
+    for (PointId idx = sel.first(); idx < sel.size(); idx = sel.next(idx))
+    {
+        EXPECT_EQ(idx % 3, 0u);
+        last = idx;
+        cnt++;
+    }
+    EXPECT_EQ(cnt, 34u);
+    EXPECT_EQ(last, 99u);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->finalize();
+
+    PointView view(table);
+    for (PointId idx = 0; idx < 200; ++idx)
+        view.setField(Dimension::Id::X, idx, idx);
+    PointViewPtr subset = view.makeSubset(sel);
+    ASSERT_EQ(subset->size(), 34u);
+    for (PointId idx = 0; idx < subset->size(); ++idx)
+        EXPECT_EQ(subset->getFieldAs<int>(Dimension::Id::X, idx),
+            3 * (int)idx);
+
+    PointSelection none(200);
+    for (PointId idx = 0; idx < 200; ++idx)
+        none.clear(idx);
+    EXPECT_EQ(none.first(), 200u);
+    EXPECT_EQ(view.makeSubset(none)->size(), 0u);
+}
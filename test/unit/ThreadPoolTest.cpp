@@ -0,0 +1,294 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <pdal/GlobalEnvironment.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/ThreadPool.hpp>
+#include <LasReader.hpp>
+#include <MergeFilter.hpp>
+#include <SplitterFilter.hpp>
+#include <TransformationFilter.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+TEST(ThreadPoolTest, runsAll)
+{
+    std::atomic<int> count(0);
+    {
+        ThreadPool pool(4);
+        EXPECT_EQ(pool.numThreads(), 4u);
+        for (int i = 0; i < 1000; ++i)
+            pool.add([&count](){ count++; });
+        // The calling thread can help.
+        while (pool.runOne())
+            ;
+    }
+    EXPECT_EQ(count, 1000);
+}
+
+namespace
+{
+
+// Sets the process-wide thread count and branch limit for its lifetime,
+// so that a failure or exception doesn't leave them set for the tests
+// that follow.
+class ThreadsGuard
+{
+public:
+    ThreadsGuard(size_t threads, size_t maxBranches = 0)
+    {
+        GlobalEnvironment::get().setThreads(threads);
+        GlobalEnvironment::get().setMaxBranches(maxBranches);
+    }
+    ~ThreadsGuard()
+    {
+        GlobalEnvironment::get().setMaxBranches(0);
+        GlobalEnvironment::get().setThreads(1);
+    }
+};
+
+void transformSplit(std::vector<double>& zs)
+{
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    Options splitOps;
+    splitOps.add("length", 100);
+    SplitterFilter splitter;
+    splitter.setOptions(splitOps);
+    splitter.setInput(reader);
+
+    Options xformOps;
+    xformOps.add("matrix", "1 0 0 0 0 1 0 0 0 0 2 1 0 0 0 1");
+    TransformationFilter xform;
+    xform.setOptions(xformOps);
+    xform.setInput(splitter);
+
+    PointTable table;
+    xform.prepare(table);
+    PointViewSet viewSet = xform.execute(table);
+    EXPECT_GT(viewSet.size(), 1u);
+
+    for (auto& view : viewSet)
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            zs.push_back(view->getFieldAs<double>(Dimension::Id::Z, idx));
+}
+
+} // unnamed namespace
+
+TEST(ThreadPoolTest, parallelStage)
+{
+    std::vector<double> serial;
+    std::vector<double> parallel;
+
+    transformSplit(serial);
+    {
+        ThreadsGuard guard(4);
+        transformSplit(parallel);
+    }
+
+    ASSERT_EQ(serial.size(), parallel.size());
+    std::sort(serial.begin(), serial.end());
+    std::sort(parallel.begin(), parallel.end());
+    for (size_t i = 0; i < serial.size(); ++i)
+        EXPECT_DOUBLE_EQ(serial[i], parallel[i]);
+}
+
+namespace
+{
+
+void mergeBranches(std::vector<double>& xs, BasePointTable& table)
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader1;
+    reader1.setOptions(ops1);
+
+    Options ops2;
+    ops2.add("filename", Support::datapath("las/simple.las"));
+    LasReader reader2;
+    reader2.setOptions(ops2);
+
+    Options ops3;
+    ops3.add("filename", Support::datapath("las/1.2-with-color-clipped.las"));
+    LasReader reader3;
+    reader3.setOptions(ops3);
+
+    MergeFilter merge;
+    merge.setInput(reader1);
+    merge.setInput(reader2);
+    merge.setInput(reader3);
+
+    merge.prepare(table);
+    PointViewSet viewSet = merge.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+
+    PointViewPtr view = *viewSet.begin();
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        xs.push_back(view->getFieldAs<double>(Dimension::Id::X, idx));
+}
+
+} // unnamed namespace
+
+TEST(ThreadPoolTest, parallelBranches)
+{
+    std::vector<double> serial;
+    std::vector<double> parallel;
+
+    PointTable serialTable;
+    mergeBranches(serial, serialTable);
+    PointTable parallelTable;
+    {
+        ThreadsGuard guard(4);
+        mergeBranches(parallel, parallelTable);
+    }
+
+    // Branch results are appended in input order, so the output must
+    // match the serial run point for point.
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+        EXPECT_DOUBLE_EQ(serial[i], parallel[i]);
+}
+
+namespace
+{
+
+// A reader that records the most readers that are reading at once.
+class BranchProbe : public Reader
+{
+public:
+    BranchProbe(std::atomic<int>& live, std::atomic<int>& peak) :
+        m_live(live), m_peak(peak)
+    {}
+
+    std::string getName() const
+        { return "readers.branchprobe"; }
+
+private:
+    std::atomic<int>& m_live;
+    std::atomic<int>& m_peak;
+
+    virtual void addDimensions(PointLayoutPtr layout)
+        { layout->registerDim(Dimension::Id::X); }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t /*num*/)
+    {
+        int live = ++m_live;
+        int peak = m_peak;
+        while (live > peak && !m_peak.compare_exchange_weak(peak, live))
+            ;
+        // Give the other branches time to start.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (int i = 0; i < 10; ++i)
+            view->setField(Dimension::Id::X, view->size(), i);
+        m_live--;
+        return 10;
+    }
+};
+
+// The most branches that ran at once when merging eight of them.
+int peakBranches(size_t maxBranches)
+{
+    std::atomic<int> live(0);
+    std::atomic<int> peak(0);
+
+    std::vector<std::unique_ptr<BranchProbe>> probes;
+    MergeFilter merge;
+    for (int i = 0; i < 8; ++i)
+    {
+        probes.emplace_back(new BranchProbe(live, peak));
+        merge.setInput(*probes.back());
+    }
+
+    ThreadsGuard guard(4, maxBranches);
+    PointTable table;
+    merge.prepare(table);
+    PointViewSet viewSet = merge.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    EXPECT_EQ((*viewSet.begin())->size(), 80u);
+    return peak;
+}
+
+} // unnamed namespace
+
+TEST(ThreadPoolTest, branchLimit)
+{
+    EXPECT_LE(peakBranches(2), 2);
+    EXPECT_LE(peakBranches(3), 3);
+    // By default, one branch runs for each thread.
+    EXPECT_LE(peakBranches(0), 4);
+    EXPECT_EQ(peakBranches(1), 1);
+}
+
+// Branches use tables of the main table's kind and give the same points
+// whatever the branch limit.
+TEST(ThreadPoolTest, branchTables)
+{
+    std::vector<double> serial;
+    PointTable serialTable;
+    mergeBranches(serial, serialTable);
+
+    auto check = [&serial](BasePointTable& table, size_t maxBranches)
+    {
+        std::vector<double> parallel;
+        {
+            ThreadsGuard guard(4, maxBranches);
+            mergeBranches(parallel, table);
+        }
+
+        ASSERT_EQ(serial.size(), parallel.size());
+        for (size_t i = 0; i < serial.size(); ++i)
+            EXPECT_DOUBLE_EQ(serial[i], parallel[i]);
+    };
+
+    ColumnPointTable columnTable;
+    check(columnTable, 0);
+    ColumnPointTable limitTable;
+    check(limitTable, 2);
+    PointTable oneTable;
+    check(oneTable, 1);
+    MappedPointTable mappedTable(Support::temppath());
+    check(mappedTable, 2);
+}
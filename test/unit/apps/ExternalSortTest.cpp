@@ -0,0 +1,162 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include <LasReader.hpp>
+#include <ExternalSort.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Sort simple.las in runs of 'runSize' points and merge them, at most
+// 'maxFanIn' runs at a time.
+PointViewPtr externalSort(const SortKeyList& keys, point_count_t runSize,
+    size_t bufferBytes, size_t& numRuns,
+    size_t maxFanIn = SortRunReader::DefaultFanIn)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/simple.las"));
+    LasReader reader;
+    reader.setOptions(ops);
+
+    SortRunList runs("");
+    StreamPointTable runTable(runSize);
+    SortRunWriter writer(keys, runs, NULL);
+    writer.setInput(reader);
+    writer.prepare(runTable);
+    writer.execute(runTable);
+    numRuns = runs.m_runs.size();
+
+    PointTable table;
+    SortRunReader merger(runs, bufferBytes, maxFanIn);
+    merger.prepare(table);
+    PointViewSet viewSet = merger.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    // Earlier passes leave no more runs than are merged at once.
+    EXPECT_LE(runs.m_runs.size(), maxFanIn);
+    return *viewSet.begin();
+}
+
+} // unnamed namespace
+
+TEST(ExternalSortTest, dimensions)
+{
+    SortKeyList keys;
+    keys.push_back(SortKey(Dimension::Id::Classification));
+    keys.push_back(SortKey(Dimension::Id::Z, true));
+
+    size_t numRuns;
+    // Small buffers make the merge refill them many times.
+    PointViewPtr view = externalSort(keys, 100, 1000, numRuns);
+    EXPECT_EQ(numRuns, 11u);
+    EXPECT_EQ(view->size(), 1065u);
+    for (PointId i = 1; i < view->size(); ++i)
+    {
+        int c1 = view->getFieldAs<int>(Dimension::Id::Classification, i - 1);
+        int c2 = view->getFieldAs<int>(Dimension::Id::Classification, i);
+        EXPECT_LE(c1, c2);
+        if (c1 == c2)
+            EXPECT_GE(view->getFieldAs<double>(Dimension::Id::Z, i - 1),
+                view->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+}
+
+TEST(ExternalSortTest, curve)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/simple.las"));
+    LasReader reader;
+    reader.setOptions(ops);
+    QuickInfo qi = reader.preview();
+    BOX2D bounds(qi.m_bounds.minx, qi.m_bounds.miny,
+        qi.m_bounds.maxx, qi.m_bounds.maxy);
+
+    SortKeyList keys;
+    keys.push_back(SortKey(SortKey::Hilbert, bounds));
+
+    size_t numRuns;
+    PointViewPtr view = externalSort(keys, 300, 1 << 20, numRuns);
+    EXPECT_EQ(numRuns, 4u);
+    EXPECT_EQ(view->size(), 1065u);
+
+    // The merged points are in curve order.
+    std::vector<uint64_t> codes = PointSorter::keyValues(*view, keys[0]);
+    for (size_t i = 1; i < codes.size(); ++i)
+        EXPECT_LE(codes[i - 1], codes[i]);
+}
+
+// More runs than are merged at once are merged in several passes, which
+// should give the same order as a single merge.
+TEST(ExternalSortTest, fanIn)
+{
+    SortKeyList keys;
+    keys.push_back(SortKey(Dimension::Id::Classification));
+
+    size_t numRuns;
+    PointViewPtr single = externalSort(keys, 10, 1 << 20, numRuns);
+    EXPECT_EQ(numRuns, 107u);
+    PointViewPtr multi = externalSort(keys, 10, 1 << 20, numRuns, 4);
+    EXPECT_EQ(numRuns, 107u);
+
+    ASSERT_EQ(multi->size(), 1065u);
+    ASSERT_EQ(single->size(), multi->size());
+    for (PointId i = 0; i < multi->size(); ++i)
+        for (Dimension::Id::Enum dim : { Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z, Dimension::Id::Classification })
+            EXPECT_EQ(single->getFieldAs<double>(dim, i),
+                multi->getFieldAs<double>(dim, i));
+}
+
+// Dimensions that aren't standard ones are found in the input's layout.
+TEST(ExternalSortTest, extraDimension)
+{
+    std::string outfile(Support::temppath("sorted.las"));
+    FileUtils::deleteFile(outfile);
+
+    std::string cmd = Support::binpath("pdal sort") + " -i " +
+        Support::datapath("las/extrabytes.las") + " -o " + outfile +
+        " --dimension Colors0 --run-memory 1 2>&1";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_TRUE(FileUtils::fileExists(outfile));
+    FileUtils::deleteFile(outfile);
+}
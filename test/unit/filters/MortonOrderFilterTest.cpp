@@ -0,0 +1,237 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <random>
+
+#include <LasReader.hpp>
+#include <MortonOrderFilter.hpp>
+#include <pdal/StageWrapper.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Points at the cells of a grid 'size' cells on each side, in random
+// order.  Sorting them puts them in the order of the curve through the
+// cells.
+PointViewPtr sortGrid(PointTableRef table, const std::string& curve,
+    int size, bool threeD)
+{
+    using namespace Dimension;
+
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Y);
+    table.layout()->registerDim(Id::Z);
+
+    std::vector<int> cells(size * size * (threeD ? size : 1));
+    for (size_t i = 0; i < cells.size(); ++i)
+        cells[i] = (int)i;
+    std::shuffle(cells.begin(), cells.end(), std::default_random_engine());
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < cells.size(); ++i)
+    {
+        view->setField(Id::X, i, cells[i] % size);
+        view->setField(Id::Y, i, (cells[i] / size) % size);
+        view->setField(Id::Z, i, cells[i] / (size * size));
+    }
+
+    Options opts;
+    opts.add("curve", curve);
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view);
+    FilterWrapper::done(filter, table);
+    EXPECT_EQ(view->size(), cells.size());
+    return view;
+}
+
+uint64_t code(const PointView& view, PointId idx, bool threeD)
+{
+    using namespace Dimension;
+
+    uint32_t x = view.getFieldAs<uint32_t>(Id::X, idx);
+    uint32_t y = view.getFieldAs<uint32_t>(Id::Y, idx);
+    uint32_t z = view.getFieldAs<uint32_t>(Id::Z, idx);
+    return threeD ? PointSorter::mortonCode(x, y, z) :
+        PointSorter::mortonCode(x, y);
+}
+
+} // unnamed namespace
+
+TEST(MortonOrderFilterTest, morton)
+{
+    PointTable table;
+    PointViewPtr view = sortGrid(table, "morton", 4, false);
+    for (PointId i = 1; i < view->size(); ++i)
+        EXPECT_LT(code(*view, i - 1, false), code(*view, i, false));
+}
+
+TEST(MortonOrderFilterTest, morton3d)
+{
+    PointTable table;
+    PointViewPtr view = sortGrid(table, "morton3d", 4, true);
+    for (PointId i = 1; i < view->size(); ++i)
+        EXPECT_LT(code(*view, i - 1, true), code(*view, i, true));
+}
+
+// The comparator that filters.mortonorder ordered points with before it
+// computed codes.  Coordinates are positions within the bounds scaled to
+// 31 bits.
+bool zLess(const std::pair<double, double>& c1,
+    const std::pair<double, double>& c2)
+{
+    auto lessMsb = [](int x, int y){ return x < y && x < (x ^ y); };
+
+    int a[2] = { (int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX) };
+    int b[2] = { (int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX) };
+    int j = 0;
+    int x = 0;
+    for (int k = 0; k < 2; k++)
+    {
+        int y = a[k] ^ b[k];
+        if (lessMsb(x, y))
+        {
+            j = k;
+            x = y;
+        }
+    }
+    return (a[j] - b[j]) < 0;
+}
+
+// The morton curve orders points as the comparator did.
+TEST(MortonOrderFilterTest, sameAsComparator)
+{
+    using namespace Dimension;
+
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    PointTable inTable;
+    reader.prepare(inTable);
+    PointViewPtr in = *reader.execute(inTable).begin();
+
+    BOX2D bounds;
+    in->calculateBounds(bounds);
+    double xrange = bounds.maxx - bounds.minx;
+    double yrange = bounds.maxy - bounds.miny;
+    std::vector<std::pair<double, double>> coords;
+    for (PointId idx = 0; idx < in->size(); ++idx)
+        coords.push_back(std::make_pair(
+            (in->getFieldAs<double>(Id::X, idx) - bounds.minx) / xrange,
+            (in->getFieldAs<double>(Id::Y, idx) - bounds.miny) / yrange));
+    std::vector<PointId> expected(in->size());
+    for (PointId idx = 0; idx < expected.size(); ++idx)
+        expected[idx] = idx;
+    std::stable_sort(expected.begin(), expected.end(),
+        [&coords](PointId a, PointId b)
+            { return zLess(coords[a], coords[b]); });
+
+    LasReader reader2;
+    reader2.setOptions(readerOps);
+    MortonOrderFilter filter;
+    filter.setInput(reader2);
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewPtr out = *filter.execute(table).begin();
+    ASSERT_EQ(out->size(), expected.size());
+    for (PointId idx = 0; idx < out->size(); ++idx)
+    {
+        PointId e = expected[idx];
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::X, idx),
+            in->getFieldAs<double>(Id::X, e));
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::Y, idx),
+            in->getFieldAs<double>(Id::Y, e));
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::Z, idx),
+            in->getFieldAs<double>(Id::Z, e));
+    }
+}
+
+// Each point on a Hilbert curve is next to the one before it.
+TEST(MortonOrderFilterTest, hilbert)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = sortGrid(table, "Hilbert", 16, false);
+    for (PointId i = 1; i < view->size(); ++i)
+    {
+        int dx = view->getFieldAs<int>(Id::X, i) -
+            view->getFieldAs<int>(Id::X, i - 1);
+        int dy = view->getFieldAs<int>(Id::Y, i) -
+            view->getFieldAs<int>(Id::Y, i - 1);
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1);
+    }
+}
+
+// Dimensions are asked for before the stage processes its options.
+TEST(MortonOrderFilterTest, usedDims)
+{
+    Options opts;
+    opts.add("curve", "morton3d");
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+
+    StringList dims;
+    EXPECT_TRUE(filter.usedDims(dims));
+    EXPECT_EQ(dims, StringList({ "X", "Y", "Z" }));
+
+    MortonOrderFilter filter2d;
+    EXPECT_TRUE(filter2d.usedDims(dims));
+    EXPECT_EQ(dims, StringList({ "X", "Y" }));
+}
+
+TEST(MortonOrderFilterTest, badCurve)
+{
+    Options opts;
+    opts.add("curve", "peano");
+
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
@@ -34,6 +34,9 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/BufferReader.hpp>
+#include <pdal/Filter.hpp>
+#include <pdal/PointSelection.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <FauxReader.hpp>
@@ -41,6 +44,35 @@
 
 using namespace pdal;
 
+namespace
+{
+
+// A selecting stage that keeps every point and records the view and the
+// selection it's given.
+class SelectProbe : public Filter
+{
+public:
+    SelectProbe() : m_viewSize(0), m_selected(0)
+    {}
+
+    std::string getName() const
+        { return "filters.selectprobe"; }
+    virtual bool selects() const
+        { return true; }
+
+    point_count_t m_viewSize;
+    point_count_t m_selected;
+
+private:
+    virtual void select(PointView& view, PointSelection& sel)
+    {
+        m_viewSize = view.size();
+        m_selected = sel.count();
+    }
+};
+
+} // unnamed namespace
+
 TEST(RangeFilterTest, createStage)
 {
     StageFactory f;
@@ -308,3 +340,80 @@ TEST(RangeFilterTest, negativeValues)
     EXPECT_FLOAT_EQ(1.0, view->getFieldAs<double>(Dimension::Id::Z, 2));
 }
 
+// A range filter feeding a decimation filter are run as one pass, so
+// decimation counts the points that passed the range.  The stage after
+// them is given the reader's view with the points they dropped cleared
+// from the selection, rather than a view made by each.
+TEST(RangeFilterTest, chained)
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+    ops.add("mode", "ramp");
+    ops.add("num_points", 100);
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options range;
+    range.add("min", 10);
+    range.add("max", 59);
+    Option dim("dimension", "Z");
+    dim.setOptions(range);
+    Options rangeOps;
+    rangeOps.add(dim);
+
+    RangeFilter filter;
+    filter.setOptions(rangeOps);
+    filter.setInput(reader);
+
+    Options decOps;
+    decOps.add("step", 10);
+    decOps.add("offset", 1);
+
+    StageFactory f;
+    std::unique_ptr<Stage> decimation(f.createStage("filters.decimation"));
+    decimation->setOptions(decOps);
+    decimation->setInput(filter);
+
+    SelectProbe probe;
+    probe.setInput(*decimation);
+
+    PointTable table;
+    probe.prepare(table);
+    PointViewSet viewSet = probe.execute(table);
+    EXPECT_EQ(probe.m_viewSize, 100u);
+    EXPECT_EQ(probe.m_selected, 5u);
+
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    ASSERT_EQ(view->size(), 5u);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Z, idx),
+            11.0 + 10 * idx);
+}
+
+// An empty input view is dropped rather than passed on.
+TEST(RangeFilterTest, emptyView)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    BufferReader reader;
+    reader.addView(PointViewPtr(new PointView(table)));
+
+    Options range;
+    range.add("min", 0);
+    range.add("max", 1);
+    Option dim("dimension", "Z");
+    dim.setOptions(range);
+    Options rangeOps;
+    rangeOps.add(dim);
+
+    RangeFilter filter;
+    filter.setOptions(rangeOps);
+    filter.setInput(reader);
+
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 0u);
+}
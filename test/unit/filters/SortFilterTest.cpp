@@ -37,6 +37,7 @@
 #include <random>
 
 #include <SortFilter.hpp>
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/PipelineReader.hpp>
 #include <pdal/StageWrapper.hpp>
@@ -110,3 +111,79 @@ TEST(SortFilterTest, pipeline)
         EXPECT_TRUE(d1 <= d2);
     }
 }
+
+// Sort on time, descending, then on return number.  Points with the same
+// keys keep their order.
+TEST(SortFilterTest, multipleDimensions)
+{
+    using namespace Dimension;
+
+    Options opts;
+    opts.add("dimension", "GpsTime");
+    opts.add("dimension", "ReturnNumber");
+    opts.add("order", "DESC");
+    opts.add("order", "asc");
+
+    SortFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    table.layout()->registerDim(Id::GpsTime);
+    table.layout()->registerDim(Id::ReturnNumber);
+    table.layout()->registerDim(Id::PointSourceId);
+    PointViewPtr view(new PointView(table));
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> times(-5, 5);
+    std::uniform_int_distribution<int> returns(1, 3);
+    for (PointId i = 0; i < 1000; ++i)
+    {
+        view->setField(Id::GpsTime, i, times(generator) / 2.0);
+        view->setField(Id::ReturnNumber, i, returns(generator));
+        view->setField(Id::PointSourceId, i, i);
+    }
+
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+
+    ASSERT_EQ(view->size(), 1000u);
+    for (PointId i = 1; i < view->size(); ++i)
+    {
+        double t1 = view->getFieldAs<double>(Id::GpsTime, i - 1);
+        double t2 = view->getFieldAs<double>(Id::GpsTime, i);
+        int r1 = view->getFieldAs<int>(Id::ReturnNumber, i - 1);
+        int r2 = view->getFieldAs<int>(Id::ReturnNumber, i);
+        int s1 = view->getFieldAs<int>(Id::PointSourceId, i - 1);
+        int s2 = view->getFieldAs<int>(Id::PointSourceId, i);
+        EXPECT_GE(t1, t2);
+        if (t1 == t2)
+        {
+            EXPECT_LE(r1, r2);
+            if (r1 == r2)
+                EXPECT_LT(s1, s2);
+        }
+    }
+}
+
+TEST(SortFilterTest, badOrder)
+{
+    Options opts;
+    opts.add("dimension", "X");
+    opts.add("order", "UP");
+
+    SortFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
+
+// Large views are sorted by several threads when there's a thread pool.
+TEST(SortFilterTest, threads)
+{
+    GlobalEnvironment::get().setThreads(4);
+    doSort(1000000);
+    GlobalEnvironment::get().setThreads(1);
+}
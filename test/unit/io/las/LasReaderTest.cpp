@@ -36,8 +36,14 @@
 
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <CropFilter.hpp>
 #include <LasReader.hpp>
+#include <LasWriter.hpp>
+#include <RangeFilter.hpp>
+#include <TextWriter.hpp>
 #include "Support.hpp"
+#include "LasTestUtils.hpp"
 
 using namespace pdal;
 
@@ -142,6 +148,7 @@ TEST(LasReaderTest, header)
     EXPECT_EQ(h.vlrOffset(), 227);
     EXPECT_EQ(h.pointFormat(), 3);
     EXPECT_EQ(h.pointCount(), 1065u);
+    EXPECT_EQ(reader.numPoints(), 1065u);
     EXPECT_DOUBLE_EQ(h.scaleX(), .01);
     EXPECT_DOUBLE_EQ(h.scaleY(), .01);
     EXPECT_DOUBLE_EQ(h.scaleZ(), .01);
@@ -411,3 +418,416 @@ TEST(LasReaderTest, LasHeaderIncorrentPointcount)
 
     EXPECT_EQ(1064u, view->size());
 }
+
+
+// Dimensions that no later stage reads shouldn't be loaded.
+TEST(LasReaderTest, projection)
+{
+    std::string outfile(Support::temppath("projection.txt"));
+
+    Options readOps;
+    readOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(readOps);
+
+    Options classOps;
+    classOps.add("equals", 2);
+    Option dim("dimension", "Classification");
+    dim.setOptions(classOps);
+    Options rangeOps;
+    rangeOps.add(dim);
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(reader);
+
+    Options writerOps;
+    writerOps.add("filename", outfile);
+    writerOps.add("order", "X,Y,Z");
+    writerOps.add("keep_unspecified", false);
+    TextWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(range);
+
+    PointTable table;
+    writer.prepare(table);
+    PointLayoutPtr layout(table.layout());
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::X));
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::Classification));
+    EXPECT_FALSE(layout->hasDim(Dimension::Id::Intensity));
+    EXPECT_FALSE(layout->hasDim(Dimension::Id::GpsTime));
+    EXPECT_FALSE(layout->hasDim(Dimension::Id::Red));
+
+    PointViewSet viewSet = writer.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->pointSize(), 3 * sizeof(double) + sizeof(uint8_t));
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::Classification, idx),
+            2);
+
+    // Executing the reader directly yields all of its dimensions.
+    PointTable table2;
+    reader.prepare(table2);
+    EXPECT_TRUE(table2.layout()->hasDim(Dimension::Id::Intensity));
+    EXPECT_TRUE(table2.layout()->hasDim(Dimension::Id::Red));
+
+    FileUtils::deleteFile(outfile);
+}
+
+
+namespace
+{
+
+// Crop and range predicates should be checked by the reader, so that
+// points that fail them are never stored.  The read callback is called
+// for each point that's stored.
+void testPredicates(const std::string& filename)
+{
+    BOX2D box(636000, 849000, 637000, 851000);
+
+    Options readOps;
+    readOps.add("filename", filename);
+
+    point_count_t expected = 0;
+    {
+        LasReader reader;
+        reader.setOptions(readOps);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            double x = view->getFieldAs<double>(Dimension::Id::X, idx);
+            double y = view->getFieldAs<double>(Dimension::Id::Y, idx);
+            int c = view->getFieldAs<int>(Dimension::Id::Classification, idx);
+            if (box.contains(x, y) && c == 2)
+                expected++;
+        }
+    }
+    EXPECT_GT(expected, 0u);
+
+    point_count_t loaded = 0;
+    LasReader reader;
+    reader.setOptions(readOps);
+    reader.setReadCb([&loaded](PointView&, PointId){ loaded++; });
+
+    Options cropOps;
+    cropOps.add("bounds", box);
+    CropFilter crop;
+    crop.setOptions(cropOps);
+    crop.setInput(reader);
+
+    Options classOps;
+    classOps.add("equals", 2);
+    Option dim("dimension", "Classification");
+    dim.setOptions(classOps);
+    Options rangeOps;
+    rangeOps.add(dim);
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(crop);
+
+    PointTable table;
+    range.prepare(table);
+    PointViewSet viewSet = range.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->size(), expected);
+    EXPECT_EQ(loaded, expected);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        double x = view->getFieldAs<double>(Dimension::Id::X, idx);
+        double y = view->getFieldAs<double>(Dimension::Id::Y, idx);
+        EXPECT_TRUE(box.contains(x, y));
+    }
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, predicates)
+{
+    testPredicates(Support::datapath("las/1.2-with-color.las"));
+
+    // LAS 1.4 point formats are decoded by a different path.
+    std::string outfile(Support::temppath("predicates14.las"));
+    FileUtils::deleteFile(outfile);
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Options writerOps;
+        writerOps.add("filename", outfile);
+        writerOps.add("minor_version", 4);
+        writerOps.add("format", 6);
+
+        PointTable table;
+        LasReader reader;
+        reader.setOptions(readerOps);
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    testPredicates(outfile);
+    FileUtils::deleteFile(outfile);
+}
+
+// Points are decoded in blocks.  Reading a chunk at a time, with chunks
+// that split blocks, gives the same points as reading them all.
+TEST(LasReaderTest, chunks)
+{
+    using namespace Dimension;
+
+    Options ops;
+    ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    PointTable table;
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    ASSERT_GT(view->size(), 1024u);
+
+    PointId idx = 0;
+    StreamPointTable streamTable(7);
+    LasReader streamReader;
+    streamReader.setOptions(ops);
+    streamReader.setReadCb([&idx, view](PointView& v, PointId id)
+    {
+        for (Id::Enum dim : { Id::X, Id::Y, Id::Z, Id::Intensity,
+            Id::ReturnNumber, Id::NumberOfReturns, Id::Classification,
+            Id::ScanAngleRank, Id::PointSourceId, Id::GpsTime, Id::Red,
+            Id::Blue })
+            EXPECT_EQ(view->getFieldAs<double>(dim, idx),
+                v.getFieldAs<double>(dim, id));
+        idx++;
+    });
+    streamReader.prepare(streamTable);
+    streamReader.execute(streamTable);
+    EXPECT_EQ(idx, view->size());
+}
+
+namespace
+{
+
+PointViewPtr readTable(BasePointTable& table, const std::string& filename)
+{
+    Options ops;
+    ops.add("filename", filename);
+
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    return *viewSet.begin();
+}
+
+} // unnamed namespace
+
+// Points are written straight into the records of row tables, including
+// blocks that end partway through a decoded block.  Column tables are set
+// a field at a time.  Each gives the same points.
+TEST(LasReaderTest, tables)
+{
+    using namespace Dimension;
+
+    std::string filename(Support::datapath("las/1.2-with-color.las"));
+
+    ColumnPointTable colTable;
+    PointViewPtr colView = readTable(colTable, filename);
+    PointTable table;
+    PointViewPtr view = readTable(table, filename);
+    PointTable smallTable(BlockAllocator::heap(), 100);
+    PointViewPtr smallView = readTable(smallTable, filename);
+
+    ASSERT_GT(colView->size(), 1024u);
+    ASSERT_EQ(view->size(), colView->size());
+    ASSERT_EQ(smallView->size(), colView->size());
+    for (PointId idx = 0; idx < colView->size(); ++idx)
+        for (Id::Enum dim : { Id::X, Id::Y, Id::Z, Id::Intensity,
+            Id::ReturnNumber, Id::NumberOfReturns, Id::ScanDirectionFlag,
+            Id::EdgeOfFlightLine, Id::Classification, Id::ScanAngleRank,
+            Id::UserData, Id::PointSourceId, Id::GpsTime, Id::Red,
+            Id::Green, Id::Blue })
+        {
+            double d = colView->getFieldAs<double>(dim, idx);
+            EXPECT_EQ(d, view->getFieldAs<double>(dim, idx));
+            EXPECT_EQ(d, smallView->getFieldAs<double>(dim, idx));
+        }
+}
+
+#ifdef PDAL_HAVE_LASZIP
+namespace
+{
+
+// Write simple.las as LAZ in chunks of 100 points, which spreads its 1065
+// points across eleven chunks.
+std::string chunkedLaz()
+{
+    std::string outfile(Support::temppath("chunked.laz"));
+    LasTest::writeLaz(Support::datapath("las/simple.las"), outfile, 100, 1);
+    return outfile;
+}
+
+} // unnamed namespace
+
+// Decompressing chunks on several threads gives the same points as
+// decompressing on one.
+TEST(LasReaderTest, threads)
+{
+    using namespace Dimension;
+
+    std::string simple(Support::datapath("laz/simple.laz"));
+    std::vector<double> serial = LasTest::readValues(simple, 1);
+    EXPECT_EQ(serial.size(), 1065u * 7);
+    EXPECT_EQ(LasTest::readValues(simple, 4), serial);
+
+    // A file of many chunks, more than are decoded ahead of the reader,
+    // has its chunks handed out in file order.
+    std::string chunked = chunkedLaz();
+    std::vector<double> values =
+        LasTest::readValues(Support::datapath("las/simple.las"), 1);
+    EXPECT_EQ(LasTest::readValues(chunked, 1), values);
+    EXPECT_EQ(LasTest::readValues(chunked, 2), values);
+    EXPECT_EQ(LasTest::readValues(chunked, 4), values);
+
+    // Streamed in blocks that don't line up with the chunks.
+    Options ops;
+    ops.add("filename", chunked);
+    ops.add("threads", 3);
+    StreamPointTable table(7);
+    LasReader reader;
+    reader.setOptions(ops);
+    size_t idx = 0;
+    reader.setReadCb([&idx, &values](PointView& v, PointId id)
+    {
+        ASSERT_LT(idx * 7, values.size());
+        EXPECT_EQ(values[idx * 7], v.getFieldAs<double>(Id::X, id));
+        EXPECT_EQ(values[idx * 7 + 5],
+            v.getFieldAs<double>(Id::GpsTime, id));
+        idx++;
+    });
+    reader.prepare(table);
+    reader.execute(table);
+    EXPECT_EQ(idx, 1065u);
+
+    FileUtils::deleteFile(chunked);
+}
+#endif
+
+namespace
+{
+
+// Read points [start, start + count) of a file.  A count of zero reads
+// to the end.
+PointViewPtr readRange(PointTableRef table, const std::string& filename,
+    size_t threads, point_count_t start, point_count_t count)
+{
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("threads", threads);
+    ops.add("start", start);
+    if (count)
+        ops.add("count", count);
+
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    return *viewSet.begin();
+}
+
+void testRange(const std::string& filename, size_t threads)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = readRange(table, filename, threads, 0, 0);
+    ASSERT_EQ(view->size(), 1065u);
+
+    // Ranges within a chunk, and across chunks, for files in chunks of
+    // 100 points.
+    for (auto range : { std::make_pair(1000, 50), std::make_pair(250, 300) })
+    {
+        PointTable rangeTable;
+        PointViewPtr rangeView = readRange(rangeTable, filename, threads,
+            range.first, range.second);
+        ASSERT_EQ(rangeView->size(), (point_count_t)range.second);
+        for (PointId idx = 0; idx < rangeView->size(); ++idx)
+            for (Id::Enum dim : { Id::X, Id::Y, Id::Z, Id::GpsTime })
+                EXPECT_EQ(view->getFieldAs<double>(dim, idx + range.first),
+                    rangeView->getFieldAs<double>(dim, idx));
+    }
+
+    // The count is limited by the points after the start.
+    PointTable endTable;
+    EXPECT_EQ(readRange(endTable, filename, threads, 1000, 500)->size(),
+        65u);
+
+    PointTable badTable;
+    EXPECT_THROW(readRange(badTable, filename, threads, 2000, 0),
+        pdal_error);
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, startCount)
+{
+    testRange(Support::datapath("las/simple.las"), 1);
+#ifdef PDAL_HAVE_LASZIP
+    testRange(Support::datapath("laz/simple.laz"), 1);
+    testRange(Support::datapath("laz/simple.laz"), 4);
+
+    // Starting points are found by jumping to the chunk that holds them.
+    std::string chunked = chunkedLaz();
+    testRange(chunked, 1);
+    testRange(chunked, 4);
+    FileUtils::deleteFile(chunked);
+#endif
+}
+
+namespace
+{
+
+// Seeking before executing starts the read at that point.
+void testSeek(const std::string& filename, size_t threads)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = readRange(table, filename, threads, 0, 0);
+    ASSERT_EQ(view->size(), 1065u);
+
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("threads", threads);
+
+    PointTable seekTable;
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(seekTable);
+    EXPECT_THROW(reader.seek(2000), pdal_error);
+    reader.seek(1000);
+    PointViewSet viewSet = reader.execute(seekTable);
+    PointViewPtr seekView = *viewSet.begin();
+    ASSERT_EQ(seekView->size(), 65u);
+    for (PointId idx = 0; idx < seekView->size(); ++idx)
+        for (Id::Enum dim : { Id::X, Id::Y, Id::Z, Id::GpsTime })
+            EXPECT_EQ(view->getFieldAs<double>(dim, idx + 1000),
+                seekView->getFieldAs<double>(dim, idx));
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, seek)
+{
+    testSeek(Support::datapath("las/simple.las"), 1);
+#ifdef PDAL_HAVE_LASZIP
+    std::string chunked = chunkedLaz();
+    testSeek(chunked, 1);
+    testSeek(chunked, 4);
+    FileUtils::deleteFile(chunked);
+#endif
+}
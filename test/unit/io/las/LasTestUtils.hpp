@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+// LAZ fixtures shared by the LAS reader and writer tests.
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <LasReader.hpp>
+#include <LasWriter.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LasTest
+{
+
+// Write 'infile' to 'outfile' as LAZ in chunks of 'chunkSize' points,
+// compressed with 'threads' threads.  The creation date is fixed, so files
+// written from the same input are the same.
+inline void writeLaz(const std::string& infile, const std::string& outfile,
+    int chunkSize, size_t threads)
+{
+    using namespace pdal;
+
+    FileUtils::deleteFile(outfile);
+
+    Options readerOpts;
+    readerOpts.add("filename", infile);
+
+    Options writerOpts;
+    writerOpts.add("compression", true);
+    writerOpts.add("creation_year", 2014);
+    writerOpts.add("creation_doy", 1);
+    writerOpts.add("chunk_size", chunkSize);
+    writerOpts.add("threads", threads);
+    writerOpts.add("filename", outfile);
+
+    PointTable table;
+    LasReader reader;
+    reader.setOptions(readerOpts);
+
+    LasWriter writer;
+    writer.setOptions(writerOpts);
+    writer.setInput(reader);
+    writer.prepare(table);
+    writer.execute(table);
+}
+
+// The X, Y, Z, intensity, classification, GPS time and red values of each
+// point of 'filename', read with 'threads' threads.
+inline std::vector<double> readValues(const std::string& filename,
+    size_t threads)
+{
+    using namespace pdal;
+    using namespace pdal::Dimension;
+
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("threads", threads);
+
+    PointTable table;
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    std::vector<double> values;
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        for (Id::Enum dim : { Id::X, Id::Y, Id::Z, Id::Intensity,
+            Id::Classification, Id::GpsTime, Id::Red })
+            values.push_back(view->getFieldAs<double>(dim, idx));
+    return values;
+}
+
+} // namespace LasTest
@@ -46,6 +46,7 @@
 #include <pdal/StageWrapper.hpp>
 
 #include "Support.hpp"
+#include "LasTestUtils.hpp"
 
 namespace pdal
 {
@@ -525,3 +526,26 @@ TEST(LasWriterTest, version1_2)
 }
 **/
 
+
+#ifdef PDAL_HAVE_LASZIP
+// Chunks compressed on several threads should make the same file as a
+// single zipper.
+TEST(LasWriterTest, threads)
+{
+    std::string infile(Support::datapath("las/1.2-with-color.las"));
+    std::string serial(Support::temppath("serial.laz"));
+    std::string parallel(Support::temppath("parallel.laz"));
+
+    LasTest::writeLaz(infile, serial, 100, 1);
+    LasTest::writeLaz(infile, parallel, 100, 4);
+    EXPECT_TRUE(Support::compare_files(serial, parallel));
+
+    std::vector<double> values = LasTest::readValues(infile, 1);
+    EXPECT_EQ(values.size(), 1065u * 7);
+    EXPECT_EQ(LasTest::readValues(parallel, 1), values);
+    EXPECT_EQ(LasTest::readValues(parallel, 4), values);
+
+    FileUtils::deleteFile(serial);
+    FileUtils::deleteFile(parallel);
+}
+#endif